@@ -0,0 +1,40 @@
+#include "AuthService.h"
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
+
+AuthService::AuthService(Storage *storage, QObject *parent)
+    : QObject(parent), storage(storage), pending(0) {
+    workers.setMaxThreadCount(2);
+}
+
+AuthService::~AuthService() {
+    workers.waitForDone();
+}
+
+void AuthService::login(const QString &username, const QString &password) {
+    auto *watcher = new QFutureWatcher<int>(this);
+    connect(watcher, &QFutureWatcher<int>::finished, this, [this, watcher, username]() {
+        pending--;
+        emit loginFinished(username, watcher->result());
+        watcher->deleteLater();
+    });
+    pending++;
+    Storage *store = storage;
+    watcher->setFuture(QtConcurrent::run(&workers, [store, username, password]() {
+        return store->authenticate(username, password);
+    }));
+}
+
+void AuthService::registerUser(const QString &username, const QString &password) {
+    auto *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, username]() {
+        pending--;
+        emit registrationFinished(username, watcher->result());
+        watcher->deleteLater();
+    });
+    pending++;
+    Storage *store = storage;
+    watcher->setFuture(QtConcurrent::run(&workers, [store, username, password]() {
+        return store->registerUser(username, password);
+    }));
+}
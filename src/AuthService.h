@@ -0,0 +1,32 @@
+#ifndef AUTHSERVICE_H
+#define AUTHSERVICE_H
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include "Storage.h"
+
+// Runs password checks and registrations on worker threads so the slow
+// password hash never blocks the GUI. Results arrive as signals on the
+// thread that owns the service. The storage must be safe to call from
+// other threads (Database and MemoryStorage are).
+class AuthService : public QObject {
+    Q_OBJECT
+public:
+    explicit AuthService(Storage *storage, QObject *parent = nullptr);
+    // Waits for requests still running so none outlives the storage.
+    ~AuthService() override;
+    void login(const QString &username, const QString &password);
+    void registerUser(const QString &username, const QString &password);
+    bool isBusy() const { return pending > 0; }
+signals:
+    // userId is -1 when the credentials were rejected.
+    void loginFinished(const QString &username, int userId);
+    void registrationFinished(const QString &username, bool registered);
+private:
+    Storage *storage;
+    QThreadPool workers;
+    int pending;
+};
+
+#endif
@@ -1,15 +1,16 @@
 #include "AuthWindow.h"
+#include "StartupTrace.h"
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QPushButton>
 #include <QMessageBox>
 
-AuthWindow::AuthWindow(QWidget *parent) : QMainWindow(parent) {
-    db = new Database();
+AuthWindow::AuthWindow(StorageService *storage, QWidget *parent)
+    : QMainWindow(parent), storage(storage), db(nullptr), auth(nullptr) {
     registerWindow = nullptr;
     setMinimumSize(350, 400);
-    setupUI();
 
+    // Set before the widgets exist so each one is polished once.
     setStyleSheet(
         "QMainWindow {"
         "    background: qradialgradient(cx:0.5, cy:0.5, radius:1, fx:0.5, fy:0.5, stop:0 #0a0a1a, stop:1 #1c1c3a);"
@@ -49,6 +50,23 @@ AuthWindow::AuthWindow(QWidget *parent) : QMainWindow(parent) {
         "    font-family: 'Orbitron', 'Arial', sans-serif;"
         "}"
         );
+    setupUI();
+    StartupTrace::markFirstPaint(this, "login window painted");
+
+    if (storage->isReady()) {
+        storageReady();
+    } else {
+        connect(storage, &StorageService::ready, this, &AuthWindow::storageReady);
+    }
+}
+
+void AuthWindow::storageReady() {
+    db = storage->storage();
+    auth = new AuthService(db, this);
+    connect(auth, &AuthService::loginFinished, this, &AuthWindow::finishLogin);
+    loginButton->setEnabled(true);
+    registerButton->setEnabled(true);
+    guestButton->setEnabled(true);
 }
 
 void AuthWindow::setupUI() {
@@ -87,14 +105,17 @@ void AuthWindow::setupUI() {
     passwordEdit->setFixedWidth(200);
     formLayout->addWidget(passwordEdit);
 
-    QPushButton *loginButton = new QPushButton("LOGIN", this);
-    QPushButton *registerButton = new QPushButton("REGISTER", this);
-    QPushButton *guestButton = new QPushButton("PLAY AS GUEST", this);
+    loginButton = new QPushButton("LOGIN", this);
+    registerButton = new QPushButton("REGISTER", this);
+    guestButton = new QPushButton("PLAY AS GUEST", this);
     QPushButton *clearButton = new QPushButton("CLEAR", this);
     formLayout->addWidget(loginButton);
     formLayout->addWidget(registerButton);
     formLayout->addWidget(guestButton);
     formLayout->addWidget(clearButton);
+    loginButton->setEnabled(false);
+    registerButton->setEnabled(false);
+    guestButton->setEnabled(false);
 
     mainLayout->addLayout(formLayout);
     mainLayout->setAlignment(formLayout, Qt::AlignCenter);
@@ -121,12 +142,18 @@ void AuthWindow::attemptLogin() {
         return;
     }
 
-    int userId = db->authenticate(username, password);
+    // The password hash takes a noticeable fraction of a second; the result
+    // comes back through finishLogin.
+    loginButton->setEnabled(false);
+    auth->login(username, password);
+}
+
+void AuthWindow::finishLogin(const QString &username, int userId) {
+    Q_UNUSED(username);
+    loginButton->setEnabled(true);
     if (userId >= 0) {
         QMessageBox::information(this, "SUCCESS", "LOGGED IN SUCCESSFULLY!");
-        MainWindow *gameWindow = new MainWindow(userId, db);
-        gameWindow->show();
-        this->close();
+        openGameWindow(userId);
     } else {
         QMessageBox::warning(this, "ERROR", "INVALID USERNAME OR PASSWORD!");
     }
@@ -141,9 +168,21 @@ void AuthWindow::openRegisterWindow() {
 }
 
 void AuthWindow::playAsGuest() {
-    MainWindow *gameWindow = new MainWindow(-1, db);
+    openGameWindow(-1);
+}
+
+MainWindow *AuthWindow::openGameWindow(int userId) {
+    MainWindow *gameWindow = new MainWindow(userId, db);
+    connect(gameWindow, &MainWindow::logoutRequested, this, &AuthWindow::returnToLogin);
+    StartupTrace::markFirstPaint(gameWindow, "game window painted");
     gameWindow->show();
     this->close();
+    return gameWindow;
+}
+
+void AuthWindow::returnToLogin() {
+    clearForm();
+    show();
 }
 
 void AuthWindow::clearForm() {
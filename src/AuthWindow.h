@@ -3,24 +3,40 @@
 
 #include <QMainWindow>
 #include <QLineEdit>
-#include "Database.h"
+#include <QPushButton>
+#include "StorageService.h"
 #include "MainWindow.h"
 #include "RegisterWindow.h"
+#include "AuthService.h"
 
 class AuthWindow : public QMainWindow {
     Q_OBJECT
 public:
-    AuthWindow(QWidget *parent = nullptr);
+    explicit AuthWindow(StorageService *storage, QWidget *parent = nullptr);
+    // False until the storage has opened; the buttons that need it stay
+    // disabled until then.
+    bool isStorageReady() const { return db != nullptr; }
+    // Hides this window behind a new game window, which deletes itself on
+    // close; logging out of it brings this window back.
+    MainWindow *openGameWindow(int userId);
 private slots:
+    void storageReady();
     void attemptLogin();
+    void finishLogin(const QString &username, int userId);
     void openRegisterWindow();
     void playAsGuest();
     void clearForm();
+    void returnToLogin();
 private:
     void setupUI();
     QLineEdit *usernameEdit;
     QLineEdit *passwordEdit;
-    Database *db;
+    QPushButton *loginButton;
+    QPushButton *registerButton;
+    QPushButton *guestButton;
+    StorageService *storage;
+    Storage *db;
+    AuthService *auth;
     RegisterWindow *registerWindow;
 };
 
@@ -0,0 +1,104 @@
+#include "BoardCodec.h"
+#include <algorithm>
+
+int BoardCodec::digit(char cell) {
+    return cell == 'X' ? 1 : cell == 'O' ? 2 : 0;
+}
+
+char BoardCodec::symbol(int digit) {
+    return digit == 1 ? 'X' : digit == 2 ? 'O' : ' ';
+}
+
+int BoardCodec::encode(const char board[3][3]) {
+    int code = 0;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            code = code * 3 + digit(board[i][j]);
+    return code;
+}
+
+void BoardCodec::decode(int code, char board[3][3]) {
+    for (int cell = 8; cell >= 0; --cell) {
+        board[cell / 3][cell % 3] = symbol(code % 3);
+        code /= 3;
+    }
+}
+
+int BoardCodec::fromString(const QString &cells) {
+    int code = 0;
+    for (int i = 0; i < 9; ++i)
+        code = code * 3 + digit(i < cells.size() ? cells[i].toLatin1() : ' ');
+    return code;
+}
+
+QString BoardCodec::toString(int code) {
+    char board[3][3];
+    decode(code, board);
+    return QString::fromLatin1(&board[0][0], 9);
+}
+
+int BoardCodec::canonical(int code) {
+    // Cell index each symmetry reads from, for target cells 0..8.
+    static const int symmetries[8][9] = {
+        {0, 1, 2, 3, 4, 5, 6, 7, 8},
+        {6, 3, 0, 7, 4, 1, 8, 5, 2},
+        {8, 7, 6, 5, 4, 3, 2, 1, 0},
+        {2, 5, 8, 1, 4, 7, 0, 3, 6},
+        {2, 1, 0, 5, 4, 3, 8, 7, 6},
+        {6, 7, 8, 3, 4, 5, 0, 1, 2},
+        {0, 3, 6, 1, 4, 7, 2, 5, 8},
+        {8, 5, 2, 7, 4, 1, 6, 3, 0}
+    };
+    int digits[9];
+    for (int cell = 8, rest = code; cell >= 0; --cell, rest /= 3)
+        digits[cell] = rest % 3;
+    int best = code;
+    for (const auto &map : symmetries) {
+        int transformed = 0;
+        for (int cell = 0; cell < 9; ++cell)
+            transformed = transformed * 3 + digits[map[cell]];
+        best = std::min(best, transformed);
+    }
+    return best;
+}
+
+qint64 BoardCodec::packMoves(const QVector<int> &moves) {
+    qint64 packed = 0;
+    for (int i = 0; i < moves.size() && i < 15; ++i)
+        packed |= qint64(moves[i] + 1) << (4 * i);
+    return packed;
+}
+
+QVector<int> BoardCodec::unpackMoves(qint64 packed) {
+    QVector<int> moves;
+    for (; packed & 0xF; packed >>= 4)
+        moves.append(int(packed & 0xF) - 1);
+    return moves;
+}
+
+QByteArray BoardCodec::pack(const QVector<char> &cells) {
+    const int maskBytes = (cells.size() + 7) / 8;
+    QByteArray packed(2 * maskBytes, '\0');
+    for (int i = 0; i < cells.size(); ++i) {
+        int d = digit(cells[i]);
+        if (d) {
+            packed[(d - 1) * maskBytes + i / 8] = char(packed[(d - 1) * maskBytes + i / 8] | (1 << (i % 8)));
+        }
+    }
+    return packed;
+}
+
+QVector<char> BoardCodec::unpack(const QByteArray &packed, int cellCount) {
+    const int maskBytes = (cellCount + 7) / 8;
+    QVector<char> cells(cellCount, ' ');
+    if (packed.size() < 2 * maskBytes) {
+        return cells;
+    }
+    for (int i = 0; i < cellCount; ++i) {
+        if (packed[i / 8] & (1 << (i % 8)))
+            cells[i] = 'X';
+        else if (packed[maskBytes + i / 8] & (1 << (i % 8)))
+            cells[i] = 'O';
+    }
+    return cells;
+}
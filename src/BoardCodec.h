@@ -0,0 +1,35 @@
+#ifndef BOARDCODEC_H
+#define BOARDCODEC_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+
+// Compact integer forms of board positions. A 3x3 board is its base-3 rank
+// (' ' = 0, 'X' = 1, 'O' = 2, cell 0 most significant), always < 19683.
+// Larger boards pack into two bit masks, X cells then O cells.
+class BoardCodec {
+public:
+    static constexpr int PositionCount = 19683;
+
+    static int encode(const char board[3][3]);
+    static void decode(int code, char board[3][3]);
+    static int fromString(const QString &cells);
+    static QString toString(int code);
+
+    // Smallest code among the 8 rotations and reflections of the position.
+    static int canonical(int code);
+
+    // Move sequences as cell indices (row * 3 + col), one nibble per move
+    // holding index + 1 so that 0 terminates the sequence.
+    static qint64 packMoves(const QVector<int> &moves);
+    static QVector<int> unpackMoves(qint64 packed);
+
+    static QByteArray pack(const QVector<char> &cells);
+    static QVector<char> unpack(const QByteArray &packed, int cellCount);
+private:
+    static int digit(char cell);
+    static char symbol(int digit);
+};
+
+#endif
@@ -0,0 +1,218 @@
+#include "BoardView.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+
+static const QColor CellColor(20, 20, 40, 178);
+static const QColor PressedColor(40, 40, 60, 178);
+static const QColor LineColor(0xbb, 0x00, 0xff);
+
+BoardView::BoardView(int size, bool interactive, QWidget *parent)
+    : QWidget(parent), size(size), interactive(interactive), enabled(false), marks(size * size, ' '),
+      hints(size * size), hintColors(size * size), pressedRow(-1), pressedCol(-1), glyphSide(0) {
+    setObjectName("board");
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+QSize BoardView::sizeHint() const {
+    const int side = size <= 3 ? 100 : qMax(32, 600 / size);
+    return QSize(side * size, side * size);
+}
+
+QSize BoardView::minimumSizeHint() const {
+    return QSize(16 * size, 16 * size);
+}
+
+int BoardView::setBoard(const char board[3][3]) {
+    int changed = 0;
+    for (int i = 0; i < 3 && i < size; ++i) {
+        for (int j = 0; j < 3 && j < size; ++j) {
+            changed += setMark(i, j, board[i][j]) ? 1 : 0;
+        }
+    }
+    return changed;
+}
+
+int BoardView::setMarks(const QVector<char> &rowMajor) {
+    int changed = 0;
+    for (int index = 0; index < rowMajor.size() && index < marks.size(); ++index) {
+        changed += setMark(index / size, index % size, rowMajor[index]) ? 1 : 0;
+    }
+    return changed;
+}
+
+bool BoardView::setMark(int row, int col, char value) {
+    char &current = marks[row * size + col];
+    if (current == value) {
+        return false;
+    }
+    current = value;
+    update(cellRect(row, col));
+    return true;
+}
+
+bool BoardView::setHint(int row, int col, const QString &text, const QColor &color) {
+    const int index = row * size + col;
+    if (hints[index] == text && (text.isEmpty() || hintColors[index] == color)) {
+        return false;
+    }
+    hints[index] = text;
+    hintColors[index] = color;
+    update(cellRect(row, col));
+    return true;
+}
+
+void BoardView::clearHints() {
+    for (int index = 0; index < hints.size(); ++index) {
+        if (!hints[index].isEmpty()) {
+            setHint(index / size, index % size, QString());
+        }
+    }
+}
+
+void BoardView::setCellsEnabled(bool on) {
+    enabled = on;
+    setCursor(enabled && interactive ? Qt::PointingHandCursor : Qt::ArrowCursor);
+    if (!enabled) {
+        setPressed(-1, -1);
+    }
+}
+
+int BoardView::cellSide() const {
+    return qMax(1, qMin(width(), height()) / size);
+}
+
+QRect BoardView::gridRect() const {
+    const int side = cellSide() * size;
+    return QRect((width() - side) / 2, (height() - side) / 2, side, side);
+}
+
+QRect BoardView::cellRect(int row, int col) const {
+    const QRect grid = gridRect();
+    const int side = cellSide();
+    return QRect(grid.x() + col * side, grid.y() + row * side, side, side);
+}
+
+bool BoardView::cellAt(const QPoint &pos, int *row, int *col) const {
+    const QRect grid = gridRect();
+    if (!grid.contains(pos)) {
+        return false;
+    }
+    const int side = cellSide();
+    *row = qMin(size - 1, (pos.y() - grid.y()) / side);
+    *col = qMin(size - 1, (pos.x() - grid.x()) / side);
+    return true;
+}
+
+const QPixmap &BoardView::glyph(char symbol) {
+    const int side = cellSide();
+    if (side != glyphSide) {
+        glyphs.clear();
+        glyphSide = side;
+    }
+    auto it = glyphs.find(symbol);
+    if (it != glyphs.end()) {
+        return *it;
+    }
+    const qreal ratio = devicePixelRatioF();
+    QPixmap pixmap(QSize(side, side) * ratio);
+    pixmap.setDevicePixelRatio(ratio);
+    pixmap.fill(Qt::transparent);
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    QFont font("Orbitron");
+    font.setStyleHint(QFont::SansSerif);
+    font.setPixelSize(qMax(6, side * 2 / 5));
+    painter.setFont(font);
+    painter.setPen(symbol == 'X' ? QColor(0x00, 0xea, 0xff) : QColor(0xff, 0x00, 0xcc));
+    painter.drawText(QRect(0, 0, side, side), Qt::AlignCenter, QString(symbol));
+    painter.end();
+    return *glyphs.insert(symbol, pixmap);
+}
+
+void BoardView::paintEvent(QPaintEvent *event) {
+    QPainter painter(this);
+    const QRect dirty = event->rect();
+    painter.setClipRect(dirty);
+    const QRect grid = gridRect();
+    const QRect area = dirty & grid;
+    if (area.isEmpty()) {
+        return;
+    }
+    // Only the cells inside the dirty rectangle are drawn.
+    const int side = cellSide();
+    const int firstRow = (area.top() - grid.y()) / side;
+    const int lastRow = qMin(size - 1, (area.bottom() - grid.y()) / side);
+    const int firstCol = (area.left() - grid.x()) / side;
+    const int lastCol = qMin(size - 1, (area.right() - grid.x()) / side);
+    QFont hintFont("Orbitron");
+    hintFont.setStyleHint(QFont::SansSerif);
+    hintFont.setPixelSize(qMax(6, side / 6));
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int col = firstCol; col <= lastCol; ++col) {
+            const QRect cell = cellRect(row, col);
+            const char symbol = marks[row * size + col];
+            // Like the old buttons, only empty cells show the pressed state.
+            const bool pressed = row == pressedRow && col == pressedCol && symbol == ' ';
+            painter.fillRect(cell, pressed ? PressedColor : CellColor);
+            if (symbol != ' ') {
+                painter.drawPixmap(cell.topLeft(), glyph(symbol));
+            } else if (!hints[row * size + col].isEmpty()) {
+                painter.setPen(hintColors[row * size + col]);
+                painter.setFont(hintFont);
+                painter.drawText(cell, Qt::AlignCenter, hints[row * size + col]);
+            }
+        }
+    }
+
+    // Inner grid lines only, as the outer edge of the board has none.
+    painter.setPen(QPen(LineColor, 1));
+    for (int k = 1; k < size; ++k) {
+        const int x = grid.x() + k * side;
+        const int y = grid.y() + k * side;
+        painter.drawLine(x, grid.top(), x, grid.bottom());
+        painter.drawLine(grid.left(), y, grid.right(), y);
+    }
+}
+
+void BoardView::setPressed(int row, int col) {
+    if (row == pressedRow && col == pressedCol) {
+        return;
+    }
+    if (pressedRow >= 0) {
+        update(cellRect(pressedRow, pressedCol));
+    }
+    pressedRow = row;
+    pressedCol = col;
+    if (pressedRow >= 0) {
+        update(cellRect(pressedRow, pressedCol));
+    }
+}
+
+void BoardView::mousePressEvent(QMouseEvent *event) {
+    int row;
+    int col;
+    if (!interactive || !enabled || event->button() != Qt::LeftButton
+        || !cellAt(event->position().toPoint(), &row, &col)) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+    setPressed(row, col);
+    event->accept();
+}
+
+void BoardView::mouseReleaseEvent(QMouseEvent *event) {
+    int row;
+    int col;
+    const int fromRow = pressedRow;
+    const int fromCol = pressedCol;
+    setPressed(-1, -1);
+    // A click needs press and release on the same cell, as with a button.
+    if (!interactive || !enabled || event->button() != Qt::LeftButton
+        || !cellAt(event->position().toPoint(), &row, &col) || row != fromRow || col != fromCol) {
+        QWidget::mouseReleaseEvent(event);
+        return;
+    }
+    event->accept();
+    emit cellClicked(row, col);
+}
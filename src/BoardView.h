@@ -0,0 +1,60 @@
+#ifndef BOARDVIEW_H
+#define BOARDVIEW_H
+
+#include <QWidget>
+#include <QVector>
+#include <QHash>
+#include <QPixmap>
+#include <QColor>
+
+// A size x size board painted as one widget, shared by MainWindow and
+// ReplayWindow. Marks are drawn from glyph pixmaps cached per cell size,
+// a changed cell repaints only its own rectangle, and clicks are mapped to
+// cells from the mouse position.
+class BoardView : public QWidget {
+    Q_OBJECT
+public:
+    explicit BoardView(int size = 3, bool interactive = true, QWidget *parent = nullptr);
+    int boardSize() const { return size; }
+    char mark(int row, int col) const { return marks[row * size + col]; }
+    // Each returns the number of cells that changed; ' ' is an empty cell.
+    int setBoard(const char board[3][3]);
+    int setMarks(const QVector<char> &rowMajor);
+    bool setMark(int row, int col, char value);
+    // A short note drawn small in an empty cell, e.g. an analysis result;
+    // an empty text removes it.
+    bool setHint(int row, int col, const QString &text, const QColor &color = QColor(0xe0, 0xe0, 0xff));
+    QString hint(int row, int col) const { return hints[row * size + col]; }
+    void clearHints();
+    void setCellsEnabled(bool on);
+    bool cellsEnabled() const { return enabled; }
+    // False when `pos` is outside the grid.
+    bool cellAt(const QPoint &pos, int *row, int *col) const;
+    QRect cellRect(int row, int col) const;
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+signals:
+    void cellClicked(int row, int col);
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+private:
+    int cellSide() const;
+    QRect gridRect() const;
+    const QPixmap &glyph(char symbol);
+    void setPressed(int row, int col);
+
+    int size;
+    bool interactive;
+    bool enabled;
+    QVector<char> marks;
+    QVector<QString> hints;
+    QVector<QColor> hintColors;
+    int pressedRow;
+    int pressedCol;
+    QHash<char, QPixmap> glyphs;
+    int glyphSide;
+};
+
+#endif
@@ -0,0 +1,122 @@
+#include "ConnectionPool.h"
+#include <QThread>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+
+ConnectionPool::ConnectionPool(const QString &path, const QString &baseName, Mode mode)
+    : path(path), baseName(baseName), mode(mode), inMemory(path == ":memory:"), busyTimeout(5000),
+      nextId(0), generation(0) {
+    if (inMemory) {
+        anchorName = baseName + "_anchor";
+        openConnection(anchorName);
+    }
+}
+
+ConnectionPool::~ConnectionPool() {
+    QMutexLocker locker(&mutex);
+    for (auto it = threadConnections.begin(); it != threadConnections.end(); ++it) {
+        QObject::disconnect(it->finished);
+        QSqlDatabase::database(it->name, false).close();
+        QSqlDatabase::removeDatabase(it->name);
+    }
+    threadConnections.clear();
+    if (!anchorName.isEmpty()) {
+        QSqlDatabase::database(anchorName, false).close();
+        QSqlDatabase::removeDatabase(anchorName);
+    }
+}
+
+QSqlDatabase ConnectionPool::connection() {
+    QThread *thread = QThread::currentThread();
+    QString name;
+    QString stale;
+    {
+        QMutexLocker locker(&mutex);
+        auto it = threadConnections.find(thread);
+        if (it != threadConnections.end()) {
+            if (it->generation == generation) {
+                return QSqlDatabase::database(it->name, false);
+            }
+            // Only this thread may close its connection, so stale ones are
+            // replaced here rather than in reopenAll().
+            QObject::disconnect(it->finished);
+            stale = it->name;
+            threadConnections.erase(it);
+        }
+        name = QString("%1_%2").arg(baseName).arg(nextId++);
+        Slot slot;
+        slot.name = name;
+        slot.generation = generation;
+        // finished is emitted on the exiting thread itself, the only thread
+        // allowed to close its connection.
+        slot.finished = QObject::connect(thread, &QThread::finished, [this, thread]() {
+            release(thread);
+        });
+        threadConnections.insert(thread, slot);
+    }
+    if (!stale.isEmpty()) {
+        QSqlDatabase::database(stale, false).close();
+        QSqlDatabase::removeDatabase(stale);
+    }
+    return openConnection(name);
+}
+
+void ConnectionPool::reopenAll() {
+    QMutexLocker locker(&mutex);
+    generation++;
+}
+
+QSqlDatabase ConnectionPool::openConnection(const QString &name) {
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+    if (inMemory) {
+        // Unique per pool so separate in-memory databases stay separate.
+        db.setDatabaseName(QString("file:%1?mode=memory&cache=shared").arg(baseName));
+        db.setConnectOptions("QSQLITE_OPEN_URI");
+    } else {
+        db.setDatabaseName(path);
+        if (mode == ReadOnly) {
+            db.setConnectOptions("QSQLITE_OPEN_READONLY");
+        }
+    }
+    if (!db.open()) {
+        qDebug() << "Error: Could not open database:" << db.lastError().text();
+        return db;
+    }
+    QSqlQuery query(db);
+    query.exec(QString("PRAGMA busy_timeout = %1;").arg(busyTimeout));
+    if (inMemory) {
+        // Shared-cache readers would otherwise fail with SQLITE_LOCKED while
+        // another thread writes; busy_timeout does not cover table locks.
+        query.exec("PRAGMA read_uncommitted = 1;");
+    } else if (mode == ReadWrite) {
+        // Must precede the WAL switch, which writes the header and makes the
+        // file non-empty. Older databases are converted by TicTacToeTool
+        // enable-incremental-vacuum.
+        query.exec("PRAGMA auto_vacuum = INCREMENTAL;");
+        // Readers keep working while a writer commits.
+        query.exec("PRAGMA journal_mode = WAL;");
+    }
+    return db;
+}
+
+void ConnectionPool::release(QThread *thread) {
+    QString name;
+    {
+        QMutexLocker locker(&mutex);
+        auto it = threadConnections.find(thread);
+        if (it == threadConnections.end()) {
+            return;
+        }
+        QObject::disconnect(it->finished);
+        name = it->name;
+        threadConnections.erase(it);
+    }
+    QSqlDatabase::database(name, false).close();
+    QSqlDatabase::removeDatabase(name);
+}
+
+int ConnectionPool::openConnections() const {
+    QMutexLocker locker(&mutex);
+    return threadConnections.size();
+}
@@ -0,0 +1,55 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QMetaObject>
+
+class QThread;
+
+// One SQLite connection per thread for a single database path. QSqlDatabase
+// handles may only be used on the thread that opened them, so each thread
+// gets its own named connection, opened on first use and removed when the
+// thread finishes. ":memory:" becomes a named shared-cache database so every
+// thread sees the same data; the pool holds one extra connection to it so the
+// data outlives any single thread.
+class ConnectionPool {
+public:
+    enum Mode { ReadWrite, ReadOnly };
+
+    ConnectionPool(const QString &path, const QString &baseName, Mode mode = ReadWrite);
+    ~ConnectionPool();
+    ConnectionPool(const ConnectionPool &) = delete;
+    ConnectionPool &operator=(const ConnectionPool &) = delete;
+
+    // The calling thread's connection; invalid if it could not be opened.
+    QSqlDatabase connection();
+    int openConnections() const;
+    void setBusyTimeout(int milliseconds) { busyTimeout = milliseconds; }
+    // Makes every thread reopen its connection on its next connection() call,
+    // e.g. after the file at `path` was replaced.
+    void reopenAll();
+private:
+    struct Slot {
+        QString name;
+        QMetaObject::Connection finished;
+        int generation = 0;
+    };
+    QSqlDatabase openConnection(const QString &name);
+    void release(QThread *thread);
+
+    QString path;
+    QString baseName;
+    QString anchorName;
+    Mode mode;
+    bool inMemory;
+    int busyTimeout;
+    int nextId;
+    int generation;
+    mutable QMutex mutex;
+    QHash<QThread *, Slot> threadConnections;
+};
+
+#endif
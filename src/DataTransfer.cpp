@@ -0,0 +1,373 @@
+#include "DataTransfer.h"
+#include "Database.h"
+#include <QIODevice>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QMutexLocker>
+#include <QVector>
+#include <QPair>
+#include <QDebug>
+
+DataTransfer::DataTransfer(Database *db) : db(db) {
+}
+
+const DataTransfer::Table &DataTransfer::usersTable() {
+    static const Table table = {
+        "users",
+        {{"id", Integer}, {"username", Text}, {"password", Text}, {"rating_pvp", Real}, {"rating_ai", Real}},
+        "exportUsers", "importUsers"
+    };
+    return table;
+}
+
+const DataTransfer::Table &DataTransfer::gamesTable() {
+    static const Table table = {
+        "games",
+        {{"id", Integer}, {"user_id", Integer}, {"board_code", Integer}, {"result", Text},
+         {"played_at", Integer}, {"vs_ai", Integer}, {"player_symbol", Text}, {"outcome", Integer},
+         {"moves", Integer}},
+        "exportGames", "importGames"
+    };
+    return table;
+}
+
+DataTransfer::Format DataTransfer::formatFor(const QString &path) {
+    return QFileInfo(path).suffix().compare("csv", Qt::CaseInsensitive) == 0 ? Csv : JsonLines;
+}
+
+DataTransfer::Result DataTransfer::exportUsers(QIODevice *out, Format format) {
+    if (db->shardCount() > 1) {
+        // Ratings are only kept current in the shards' copies of users.
+        qDebug() << "Export users error: database is sharded; reshard to 1 first";
+        return Result();
+    }
+    return exportTable(usersTable(), out, format);
+}
+
+DataTransfer::Result DataTransfer::exportGames(QIODevice *out, Format format) {
+    if (db->shardCount() > 1) {
+        qDebug() << "Export games error: games are sharded; reshard to 1 first";
+        return Result();
+    }
+    return exportTable(gamesTable(), out, format);
+}
+
+DataTransfer::Result DataTransfer::importUsers(QIODevice *in, Format format) {
+    if (db->shardCount() > 1) {
+        // Imported rows would never reach the shard copies of users.
+        qDebug() << "Import users error: database is sharded; reshard to 1 first";
+        return Result();
+    }
+    return importTable(usersTable(), in, format);
+}
+
+DataTransfer::Result DataTransfer::importGames(QIODevice *in, Format format) {
+    if (db->shardCount() > 1) {
+        qDebug() << "Import games error: games are sharded; reshard to 1 first";
+        return Result();
+    }
+    Result result = importTable(gamesTable(), in, format);
+    if (result.ok && result.rows > 0) {
+        QElapsedTimer clock;
+        clock.start();
+        result.ok = db->rebuildUserStats() && db->rebuildPositionStats() && db->recomputeRatings();
+        result.nanos += clock.nsecsElapsed();
+    }
+    return result;
+}
+
+QByteArray DataTransfer::csvLine(const QVariantList &values) {
+    QByteArray line;
+    for (int i = 0; i < values.size(); ++i) {
+        if (i > 0) {
+            line += ',';
+        }
+        const QVariant &value = values[i];
+        if (value.isNull()) {
+            continue;
+        }
+        QByteArray field = value.toString().toUtf8();
+        // Quoting an empty string keeps it distinct from NULL.
+        if (field.isEmpty() || field.contains(',') || field.contains('"') || field.contains('\n') || field.contains('\r')) {
+            field.replace("\"", "\"\"");
+            field = '"' + field + '"';
+        }
+        line += field;
+    }
+    return line;
+}
+
+bool DataTransfer::parseCsvLine(const QByteArray &line, QList<QVariant> *fields) {
+    fields->clear();
+    int i = 0;
+    while (true) {
+        if (i < line.size() && line[i] == '"') {
+            QByteArray field;
+            ++i;
+            while (true) {
+                if (i >= line.size()) {
+                    return false;
+                }
+                if (line[i] == '"') {
+                    if (i + 1 < line.size() && line[i + 1] == '"') {
+                        field += '"';
+                        i += 2;
+                        continue;
+                    }
+                    ++i;
+                    break;
+                }
+                field += line[i++];
+            }
+            fields->append(QString::fromUtf8(field));
+        } else {
+            int end = line.indexOf(',', i);
+            if (end < 0) {
+                end = line.size();
+            }
+            QByteArray field = line.mid(i, end - i);
+            fields->append(field.isEmpty() ? QVariant() : QVariant(QString::fromUtf8(field)));
+            i = end;
+        }
+        if (i >= line.size()) {
+            return true;
+        }
+        if (line[i] != ',') {
+            return false;
+        }
+        ++i;
+    }
+}
+
+QVariant DataTransfer::convert(const QVariant &value, Kind kind, bool *ok) {
+    *ok = true;
+    if (value.isNull()) {
+        return QVariant();
+    }
+    switch (kind) {
+    case Integer: {
+        // JSON numbers arrive as doubles, CSV fields as strings.
+        if (value.typeId() == QMetaType::Double) {
+            return QVariant(qint64(value.toDouble()));
+        }
+        qint64 number = value.toString().toLongLong(ok);
+        return *ok ? QVariant(number) : QVariant();
+    }
+    case Real: {
+        double number = value.toDouble(ok);
+        return *ok ? QVariant(number) : QVariant();
+    }
+    case Text:
+        return QVariant(value.toString());
+    }
+    return QVariant();
+}
+
+DataTransfer::Result DataTransfer::exportTable(const Table &table, QIODevice *out, Format format) {
+    QueryTimer timer(db->queryStatistics, table.exportOperation);
+    Result result;
+    QElapsedTimer clock;
+    clock.start();
+
+    QStringList names;
+    for (const Column &column : table.columns) {
+        names << column.name;
+    }
+    QSqlDatabase connection = db->connections.connection();
+    QSqlQuery query(connection);
+    query.setForwardOnly(true);
+    if (!query.exec(QString("SELECT %1 FROM %2 ORDER BY id;").arg(names.join(", "), table.name))) {
+        qDebug() << "Export" << table.name << "error:" << query.lastError().text();
+        return result;
+    }
+    timer.track(query);
+    if (format == Csv && out->write(names.join(',').toUtf8() + '\n') < 0) {
+        qDebug() << "Export" << table.name << "error:" << out->errorString();
+        return result;
+    }
+
+    QByteArray line;
+    QVariantList values;
+    while (query.next()) {
+        values.clear();
+        for (int i = 0; i < table.columns.size(); ++i) {
+            values << query.value(i);
+        }
+        if (format == Csv) {
+            line = csvLine(values);
+        } else {
+            QJsonObject object;
+            for (int i = 0; i < table.columns.size(); ++i) {
+                object.insert(table.columns[i].name,
+                              values[i].isNull() ? QJsonValue(QJsonValue::Null) : QJsonValue::fromVariant(values[i]));
+            }
+            line = QJsonDocument(object).toJson(QJsonDocument::Compact);
+        }
+        line += '\n';
+        if (out->write(line) != line.size()) {
+            qDebug() << "Export" << table.name << "error:" << out->errorString();
+            return result;
+        }
+        result.rows++;
+    }
+    timer.addRows(result.rows);
+    result.ok = true;
+    result.nanos = clock.nsecsElapsed();
+    return result;
+}
+
+DataTransfer::Result DataTransfer::importTable(const Table &table, QIODevice *in, Format format) {
+    QueryTimer timer(db->queryStatistics, table.importOperation);
+    Result result;
+    QElapsedTimer clock;
+    clock.start();
+    QMutexLocker writeLock(&db->writeMutex);
+    QSqlDatabase connection = db->connections.connection();
+
+    // For CSV the header decides which field feeds which column; JSON is by name.
+    QVector<int> fieldForColumn(table.columns.size(), -1);
+    if (format == Csv) {
+        QList<QVariant> header;
+        if (!parseCsvLine(in->readLine().trimmed(), &header)) {
+            qDebug() << "Import" << table.name << "error: unreadable CSV header";
+            return result;
+        }
+        for (int c = 0; c < table.columns.size(); ++c) {
+            for (int f = 0; f < header.size(); ++f) {
+                if (header[f].toString() == table.columns[c].name) {
+                    fieldForColumn[c] = f;
+                }
+            }
+        }
+    }
+
+    QSqlQuery query(connection);
+    QList<QPair<QString, QString>> indexes;
+    query.prepare("SELECT name, sql FROM sqlite_master WHERE type = 'index' AND tbl_name = :table AND sql IS NOT NULL;");
+    query.bindValue(":table", table.name);
+    if (!query.exec()) {
+        qDebug() << "Import" << table.name << "error:" << query.lastError().text();
+        return result;
+    }
+    while (query.next()) {
+        indexes.append({query.value(0).toString(), query.value(1).toString()});
+    }
+    query.finish();
+    for (const auto &index : indexes) {
+        query.exec(QString("DROP INDEX IF EXISTS %1;").arg(index.first));
+    }
+
+    QStringList names;
+    QStringList placeholders;
+    for (const Column &column : table.columns) {
+        names << column.name;
+        placeholders << "?";
+    }
+    QSqlQuery insert(connection);
+    const QString insertSql = QString("INSERT OR IGNORE INTO %1 (%2) VALUES (%3);")
+                                  .arg(table.name, names.join(", "), placeholders.join(", "));
+    QSqlQuery changes(connection);
+    qint64 changesBefore = 0;
+    if (changes.exec("SELECT total_changes();") && changes.next()) {
+        changesBefore = changes.value(0).toLongLong();
+    }
+    changes.finish();
+
+    QVector<QVariantList> batch(table.columns.size());
+    int batched = 0;
+    qint64 uncommitted = 0;
+    qint64 parsed = 0;
+    bool ok = connection.transaction();
+    auto flush = [&]() {
+        if (batched == 0) {
+            return true;
+        }
+        insert.prepare(insertSql);
+        for (const QVariantList &column : batch) {
+            insert.addBindValue(column);
+        }
+        bool inserted = insert.execBatch();
+        if (!inserted) {
+            qDebug() << "Import" << table.name << "error:" << insert.lastError().text();
+        }
+        for (QVariantList &column : batch) {
+            column.clear();
+        }
+        uncommitted += batched;
+        batched = 0;
+        if (inserted && uncommitted >= CommitRows) {
+            uncommitted = 0;
+            return connection.commit() && connection.transaction();
+        }
+        return inserted;
+    };
+
+    QList<QVariant> fields;
+    while (ok && !in->atEnd()) {
+        QByteArray line = in->readLine();
+        // A quoted CSV field may hold line breaks; an odd number of quotes so
+        // far means the record continues on the next line.
+        while (format == Csv && line.count('"') % 2 != 0 && !in->atEnd()) {
+            line += in->readLine();
+        }
+        while (line.endsWith('\n') || line.endsWith('\r')) {
+            line.chop(1);
+        }
+        if (line.isEmpty()) {
+            continue;
+        }
+        bool valid = true;
+        QVariantList row;
+        if (format == Csv) {
+            valid = parseCsvLine(line, &fields);
+            for (int c = 0; valid && c < table.columns.size(); ++c) {
+                int f = fieldForColumn[c];
+                row << convert(f >= 0 && f < fields.size() ? fields[f] : QVariant(), table.columns[c].kind, &valid);
+            }
+        } else {
+            QJsonParseError error;
+            QJsonObject object = QJsonDocument::fromJson(line, &error).object();
+            valid = error.error == QJsonParseError::NoError;
+            for (int c = 0; valid && c < table.columns.size(); ++c) {
+                row << convert(object.value(table.columns[c].name).toVariant(), table.columns[c].kind, &valid);
+            }
+        }
+        if (!valid || row.value(0).isNull()) {
+            result.skipped++;
+            continue;
+        }
+        for (int c = 0; c < row.size(); ++c) {
+            batch[c] << row[c];
+        }
+        parsed++;
+        if (++batched >= BatchRows) {
+            ok = flush();
+        }
+    }
+    ok = ok && flush() && connection.commit();
+    if (!ok) {
+        qDebug() << "Import" << table.name << "error:" << connection.lastError().text();
+        connection.rollback();
+    }
+
+    for (const auto &index : indexes) {
+        if (!query.exec(index.second)) {
+            qDebug() << "Import" << table.name << "index error:" << query.lastError().text();
+            ok = false;
+        }
+    }
+    if (changes.exec("SELECT total_changes();") && changes.next()) {
+        result.rows = changes.value(0).toLongLong() - changesBefore;
+    }
+    result.skipped += parsed - result.rows;
+    timer.addRows(result.rows);
+    db->cache.clear();
+    result.ok = ok;
+    result.nanos = clock.nsecsElapsed();
+    return result;
+}
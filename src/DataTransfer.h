@@ -0,0 +1,67 @@
+#ifndef DATATRANSFER_H
+#define DATATRANSFER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QByteArray>
+#include <QList>
+
+class QIODevice;
+class Database;
+
+// Streams users and games between a Database and JSON Lines or CSV. Exports
+// read one row at a time, so memory use does not grow with the table.
+// Imports keep the exported ids, skip rows whose id already exists, insert
+// in bound batches inside large transactions, and rebuild each table's
+// indexes once at the end instead of maintaining them per row.
+class DataTransfer {
+public:
+    enum Format { JsonLines, Csv };
+    struct Result {
+        bool ok = false;
+        qint64 rows = 0;
+        // Lines that could not be parsed plus rows whose id already existed.
+        qint64 skipped = 0;
+        qint64 nanos = 0;
+        double rowsPerSecond() const { return nanos > 0 ? rows * 1e9 / nanos : 0.0; }
+    };
+
+    static constexpr int BatchRows = 5000;
+    static constexpr int CommitRows = 200000;
+
+    // Every transfer needs an unsharded database.
+    explicit DataTransfer(Database *db);
+    Result exportUsers(QIODevice *out, Format format);
+    Result exportGames(QIODevice *out, Format format);
+    Result importUsers(QIODevice *in, Format format);
+    // Also rebuilds user_stats, position_stats and ratings from the result.
+    Result importGames(QIODevice *in, Format format);
+
+    // Csv for a .csv suffix, otherwise JsonLines.
+    static Format formatFor(const QString &path);
+    static QByteArray csvLine(const QVariantList &values);
+    // False when quotes are unbalanced. Unquoted empty fields become null.
+    static bool parseCsvLine(const QByteArray &line, QList<QVariant> *fields);
+private:
+    enum Kind { Integer, Real, Text };
+    struct Column {
+        const char *name;
+        Kind kind;
+    };
+    struct Table {
+        const char *name;
+        QList<Column> columns;
+        const char *exportOperation;
+        const char *importOperation;
+    };
+    static const Table &usersTable();
+    static const Table &gamesTable();
+    static QVariant convert(const QVariant &value, Kind kind, bool *ok);
+    Result exportTable(const Table &table, QIODevice *out, Format format);
+    Result importTable(const Table &table, QIODevice *in, Format format);
+
+    Database *db;
+};
+
+#endif
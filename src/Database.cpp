@@ -1,33 +1,312 @@
 #include "Database.h"
-#include <QCryptographicHash>
+#include "BoardCodec.h"
+#include "PasswordHasher.h"
 #include <QDateTime>
+#include <QVariantList>
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
+#include <QAtomicInt>
+#include <QMutexLocker>
+#include <QHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QSqlDriver>
+#include <QSqlRecord>
+#include <QtConcurrent/QtConcurrent>
+#include <cmath>
+#include <cstdio>
+#ifdef TICTACTOE_HAVE_SQLITE3
+#include <sqlite3.h>
+#endif
+#include <algorithm>
 
-Database::Database() {
-    db = QSqlDatabase::addDatabase("QSQLITE");
-    db.setDatabaseName("tictactoe.db");
-    if (!db.open()) {
-        qDebug() << "Error: Could not open database:" << db.lastError().text();
+// Runs `call` on every shard in parallel on the global thread pool; the
+// calling thread takes part too, so this is safe from a pool thread.
+template <typename Result, typename Call>
+static QList<Result> fanOut(const std::vector<std::unique_ptr<Database>> &shards, Call call) {
+    QList<Database *> targets;
+    for (const std::unique_ptr<Database> &shard : shards) {
+        targets.append(shard.get());
+    }
+    return QtConcurrent::blockingMapped<QList<Result>>(targets, call);
+}
+
+Database::Database() : Database(defaultPath()) {
+}
+
+Database::Database(const QString &path)
+    : dbPath(path), connectionName(nextConnectionName()), connections(dbPath, connectionName) {
+    open();
+}
+
+QString Database::nextConnectionName() {
+    static QAtomicInt nextConnectionId;
+    return QString("tictactoe_%1").arg(nextConnectionId.fetchAndAddRelaxed(1));
+}
+
+QString Database::defaultPath() {
+    QString path = qEnvironmentVariable("TICTACTOE_DB_PATH");
+    return path.isEmpty() ? "tictactoe.db" : path;
+}
+
+void Database::open() {
+    QMutexLocker writeLock(&writeMutex);
+    QSqlDatabase db = connections.connection();
+    if (!db.isOpen()) {
         return;
     }
 
-    QSqlQuery query;
+    QSqlQuery query(db);
     query.exec("CREATE TABLE IF NOT EXISTS users (id INTEGER PRIMARY KEY AUTOINCREMENT, username TEXT UNIQUE, password TEXT);");
     query.exec("CREATE TABLE IF NOT EXISTS games (id INTEGER PRIMARY KEY AUTOINCREMENT, user_id INTEGER, board TEXT, result TEXT, timestamp TEXT);");
+    if (migrate()) {
+        openShards();
+    }
 }
 
 Database::~Database() {
-    db.close();
+    if (qEnvironmentVariableIsSet("TICTACTOE_QUERY_STATS")) {
+        qDebug().noquote() << "Database query statistics for" << dbPath << "\n" << queryStatistics.report();
+        qDebug() << "Read cache:" << cache.hits() << "hits," << cache.misses() << "misses,"
+                 << cache.bytes() << "of" << cache.maxBytes() << "bytes";
+    }
+}
+
+bool Database::migrate() {
+    QueryTimer timer(queryStatistics, "migrate");
+    QMutexLocker writeLock(&writeMutex);
+    QSqlDatabase db = connections.connection();
+    QSqlQuery query(db);
+    int version = 0;
+    if (query.exec("PRAGMA user_version;") && query.next()) {
+        version = query.value(0).toInt();
+    }
+
+    // v1: per-game outcome/mode columns and the incrementally maintained user_stats table.
+    // Legacy rows predate the player symbol, so 'X'/'O' results are read from X's side
+    // and all of them count as PvP games.
+    if (version < 1 && !runMigration(1, {
+            "ALTER TABLE games ADD COLUMN vs_ai INTEGER NOT NULL DEFAULT 0;",
+            "ALTER TABLE games ADD COLUMN player_symbol TEXT NOT NULL DEFAULT 'X';",
+            "ALTER TABLE games ADD COLUMN outcome INTEGER;",
+            "UPDATE games SET outcome = CASE"
+            " WHEN result IN ('Tie', 'Draw') THEN 2"
+            " WHEN result IN ('Win', 'X') THEN 0"
+            " ELSE 1 END;",
+            "CREATE TABLE IF NOT EXISTS user_stats ("
+            " user_id INTEGER PRIMARY KEY,"
+            " games INTEGER NOT NULL DEFAULT 0, wins INTEGER NOT NULL DEFAULT 0,"
+            " losses INTEGER NOT NULL DEFAULT 0, ties INTEGER NOT NULL DEFAULT 0,"
+            " current_streak INTEGER NOT NULL DEFAULT 0, best_streak INTEGER NOT NULL DEFAULT 0,"
+            " ai_games INTEGER NOT NULL DEFAULT 0, ai_wins INTEGER NOT NULL DEFAULT 0,"
+            " ai_losses INTEGER NOT NULL DEFAULT 0, ai_ties INTEGER NOT NULL DEFAULT 0,"
+            " pvp_games INTEGER NOT NULL DEFAULT 0, pvp_wins INTEGER NOT NULL DEFAULT 0,"
+            " pvp_losses INTEGER NOT NULL DEFAULT 0, pvp_ties INTEGER NOT NULL DEFAULT 0);",
+            "INSERT INTO user_stats (user_id, games, wins, losses, ties, pvp_games, pvp_wins, pvp_losses, pvp_ties)"
+            " SELECT user_id, COUNT(*), SUM(outcome = 0), SUM(outcome = 1), SUM(outcome = 2),"
+            " COUNT(*), SUM(outcome = 0), SUM(outcome = 1), SUM(outcome = 2)"
+            " FROM games GROUP BY user_id;"
+        })) {
+        return false;
+    }
+
+    // v2: separate Elo ratings for PvP and vs-AI games, indexed for top-K and rank lookups.
+    if (version < 2 && !runMigration(2, {
+            "ALTER TABLE users ADD COLUMN rating_pvp REAL NOT NULL DEFAULT 1200;",
+            "ALTER TABLE users ADD COLUMN rating_ai REAL NOT NULL DEFAULT 1200;",
+            "CREATE INDEX IF NOT EXISTS idx_users_rating_pvp ON users (rating_pvp DESC, id);",
+            "CREATE INDEX IF NOT EXISTS idx_users_rating_ai ON users (rating_ai DESC, id);"
+        })) {
+        return false;
+    }
+
+    // v3: integer UTC epoch milliseconds replace the locale-formatted timestamp text.
+    // Existing rows are converted afterwards in batches so a large table never
+    // needs one long write transaction.
+    if (version < 3 && !runMigration(3, {
+            "ALTER TABLE games ADD COLUMN played_at INTEGER;",
+            "CREATE INDEX IF NOT EXISTS idx_games_played_at ON games (played_at);",
+            "CREATE INDEX IF NOT EXISTS idx_games_user_played_at ON games (user_id, played_at);"
+        })) {
+        return false;
+    }
+    if (!backfillInBatches("played_at", "timestamp", [](const QVariant &text) {
+            // Legacy rows were written with QDateTime::toString() in local time.
+            QDateTime parsed = QDateTime::fromString(text.toString());
+            return QVariant(parsed.isValid() ? parsed.toMSecsSinceEpoch() : qint64(0));
+        })) {
+        return false;
+    }
+    // Ratings replay games in played_at order, so they can only be seeded once
+    // v3 has converted every legacy timestamp.
+    if (version < 2 && !recomputeRatings()) {
+        return false;
+    }
+
+    // v4/v5: boards become their base-3 rank instead of a 9-character TEXT cell.
+    // v5 is only recorded once every legacy row has been converted.
+    if (version < 4 && !runMigration(4, {
+            "ALTER TABLE games ADD COLUMN board_code INTEGER;"
+        })) {
+        return false;
+    }
+    if (version < 5) {
+        if (!backfillInBatches("board_code", "board", [](const QVariant &text) {
+                return QVariant(BoardCodec::fromString(text.toString()));
+            }) || !runMigration(5, {})) {
+            return false;
+        }
+    }
+
+    // v6/v7: move sequences and per-position outcome counts, keyed by the
+    // canonical (symmetry-reduced) board code. Legacy games have no moves, so
+    // only their final positions are counted.
+    if (version < 6 && !runMigration(6, {
+            "ALTER TABLE games ADD COLUMN moves INTEGER NOT NULL DEFAULT 0;",
+            "CREATE TABLE IF NOT EXISTS position_stats ("
+            " position INTEGER PRIMARY KEY,"
+            " occurrences INTEGER NOT NULL DEFAULT 0, x_wins INTEGER NOT NULL DEFAULT 0,"
+            " o_wins INTEGER NOT NULL DEFAULT 0, ties INTEGER NOT NULL DEFAULT 0);"
+        })) {
+        return false;
+    }
+    if (version < 7 && (!rebuildPositionStats() || !runMigration(7, {}))) {
+        return false;
+    }
+
+    // v8: per-user totals of games removed by applyRetention().
+    if (version < 8 && !runMigration(8, {
+            "CREATE TABLE IF NOT EXISTS game_rollups ("
+            " user_id INTEGER PRIMARY KEY,"
+            " games INTEGER NOT NULL DEFAULT 0, wins INTEGER NOT NULL DEFAULT 0,"
+            " losses INTEGER NOT NULL DEFAULT 0, ties INTEGER NOT NULL DEFAULT 0,"
+            " ai_games INTEGER NOT NULL DEFAULT 0, ai_wins INTEGER NOT NULL DEFAULT 0,"
+            " ai_losses INTEGER NOT NULL DEFAULT 0, ai_ties INTEGER NOT NULL DEFAULT 0,"
+            " pvp_games INTEGER NOT NULL DEFAULT 0, pvp_wins INTEGER NOT NULL DEFAULT 0,"
+            " pvp_losses INTEGER NOT NULL DEFAULT 0, pvp_ties INTEGER NOT NULL DEFAULT 0,"
+            " best_streak INTEGER NOT NULL DEFAULT 0,"
+            " first_played_at INTEGER, last_played_at INTEGER);"
+        })) {
+        return false;
+    }
+
+    // v9: named integer settings, starting with the game shard count.
+    if (version < 9 && !runMigration(9, {
+            "CREATE TABLE IF NOT EXISTS settings (name TEXT PRIMARY KEY, value INTEGER NOT NULL);"
+        })) {
+        return false;
+    }
+
+    // v10: users per rating bucket, kept by triggers in the same transaction
+    // as every rating write, so getRank sums a few bucket rows instead of
+    // counting every user above.
+    if (version < 10) {
+        QStringList statements = {
+            "CREATE TABLE IF NOT EXISTS rating_buckets ("
+            " pool INTEGER NOT NULL, bucket INTEGER NOT NULL, users INTEGER NOT NULL DEFAULT 0,"
+            " PRIMARY KEY (pool, bucket)) WITHOUT ROWID;"
+        };
+        QString added, removed;
+        for (RatingPool pool : {PvPRating, AIRating}) {
+            const QString column = ratingColumn(pool);
+            statements << QString("INSERT INTO rating_buckets (pool, bucket, users)"
+                                  " SELECT %1, %2, COUNT(*) FROM users GROUP BY 2;")
+                              .arg(int(pool)).arg(ratingBucketSql(column));
+            added += QString(" INSERT INTO rating_buckets (pool, bucket, users) VALUES (%1, %2, 1)"
+                             " ON CONFLICT(pool, bucket) DO UPDATE SET users = users + 1;")
+                         .arg(int(pool)).arg(ratingBucketSql("NEW." + column));
+            removed += QString(" UPDATE rating_buckets SET users = users - 1 WHERE pool = %1 AND bucket = %2;")
+                           .arg(int(pool)).arg(ratingBucketSql("OLD." + column));
+        }
+        statements << QString("CREATE TRIGGER IF NOT EXISTS users_rating_insert AFTER INSERT ON users BEGIN%1 END;")
+                          .arg(added)
+                   << QString("CREATE TRIGGER IF NOT EXISTS users_rating_delete AFTER DELETE ON users BEGIN%1 END;")
+                          .arg(removed)
+                   << QString("CREATE TRIGGER IF NOT EXISTS users_rating_update AFTER UPDATE OF rating_pvp, rating_ai"
+                              " ON users BEGIN%1%2 END;").arg(removed, added);
+        if (!runMigration(10, statements)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Database::backfillInBatches(const QString &target, const QString &source,
+                                 const std::function<QVariant(const QVariant &)> &convert) {
+    QSqlDatabase db = connections.connection();
+    const int batchSize = 1000;
+    qint64 lastId = 0;
+    QSqlQuery select(db);
+    select.setForwardOnly(true);
+    QSqlQuery update(db);
+    while (true) {
+        select.prepare(QString("SELECT id, %1 FROM games "
+                               "WHERE %2 IS NULL AND id > :last_id ORDER BY id LIMIT :limit;").arg(source, target));
+        select.bindValue(":last_id", lastId);
+        select.bindValue(":limit", batchSize);
+        if (!select.exec()) {
+            qDebug() << "Backfill" << target << "error:" << select.lastError().text();
+            return false;
+        }
+        QVariantList ids;
+        QVariantList values;
+        while (select.next()) {
+            lastId = select.value(0).toLongLong();
+            ids << lastId;
+            values << convert(select.value(1));
+        }
+        select.finish();
+        if (ids.isEmpty()) {
+            return true;
+        }
+
+        if (!db.transaction()) {
+            qDebug() << "Backfill" << target << "error:" << db.lastError().text();
+            return false;
+        }
+        update.prepare(QString("UPDATE games SET %1 = ?, %2 = NULL WHERE id = ?;").arg(target, source));
+        update.addBindValue(values);
+        update.addBindValue(ids);
+        if (!update.execBatch() || !db.commit()) {
+            qDebug() << "Backfill" << target << "error:" << update.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+}
+
+bool Database::runMigration(int version, const QStringList &statements) {
+    QSqlDatabase db = connections.connection();
+    if (!db.transaction()) {
+        qDebug() << "Migration error:" << db.lastError().text();
+        return false;
+    }
+    QSqlQuery query(db);
+    for (const QString &sql : statements) {
+        if (!query.exec(sql)) {
+            qDebug() << "Migration" << version << "error:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    if (!query.exec(QString("PRAGMA user_version = %1;").arg(version)) || !db.commit()) {
+        qDebug() << "Migration" << version << "error:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
 }
 
 bool Database::isValidUserId(int userId) {
+    QSqlDatabase db = connections.connection();
     if (userId <= 0) {
         return false;
     }
     
-    QSqlQuery query;
+    QSqlQuery query(db);
     query.prepare("SELECT COUNT(*) FROM users WHERE id = ?");
     query.addBindValue(userId);
     
@@ -38,81 +317,1327 @@ bool Database::isValidUserId(int userId) {
     return query.value(0).toInt() > 0;
 }
 
-bool Database::isValidUsername(const QString& username) {
-    QString trimmedUsername = username.trimmed();
-    return !trimmedUsername.isEmpty();
-}
-
-
-QString Database::hashPassword(const QString &password) {
-    return QString(QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex());
-}
-
 int Database::authenticate(const QString &username, const QString &password) {
-    QSqlQuery query;
-    query.prepare("SELECT id FROM users WHERE username = :username AND password = :password;");
+    QueryTimer timer(queryStatistics, "authenticate");
+    QSqlDatabase db = connections.connection();
+    QSqlQuery query(db);
+    query.prepare("SELECT id, password FROM users WHERE username = :username;");
     query.bindValue(":username", username);
-    query.bindValue(":password", hashPassword(password));
-    if (!query.exec()) {
+    bool ok = query.exec();
+    timer.track(query);
+    if (!ok) {
         qDebug() << "Authenticate error:" << query.lastError().text();
         return -1;
     }
-    if (query.next()) {
-        return query.value(0).toInt();
+    if (!query.next()) {
+        return -1;
     }
-    return -1;
+    timer.addRows(1);
+    const int userId = query.value(0).toInt();
+    const QString stored = query.value(1).toString();
+    query.finish();
+    if (!verifyPassword(password, stored)) {
+        return -1;
+    }
+
+    // Upgrade legacy or under-strength hashes while the plain password is at hand.
+    if (PasswordHasher::needsRehash(stored)) {
+        const QString hash = hashPassword(password);
+        QMutexLocker writeLock(&writeMutex);
+        query.prepare("UPDATE users SET password = :hash WHERE id = :user_id AND password = :old;");
+        query.bindValue(":hash", hash);
+        query.bindValue(":user_id", userId);
+        query.bindValue(":old", stored);
+        bool rehashed = query.exec();
+        timer.track(query);
+        if (!rehashed) {
+            qDebug() << "Authenticate error:" << query.lastError().text();
+        }
+    }
+    return userId;
 }
 
 bool Database::registerUser(const QString &username, const QString &password) {
+    QueryTimer timer(queryStatistics, "registerUser");
+    QSqlDatabase db = connections.connection();
     if (!isValidUsername(username)) {
         return false;
     }
-    QSqlQuery query;
+    // Hashing is deliberately slow, so it happens before taking the write lock.
+    const QString hash = hashPassword(password);
+    QMutexLocker writeLock(&writeMutex);
+    QSqlQuery query(db);
     query.prepare("INSERT INTO users (username, password) VALUES (:username, :password);");
     query.bindValue(":username", username);
-    query.bindValue(":password", hashPassword(password));
-    if (!query.exec()) {
+    query.bindValue(":password", hash);
+    bool ok = query.exec();
+    timer.track(query);
+    if (!ok) {
         qDebug() << "Register error:" << query.lastError().text();
         return false;
     }
+    timer.addRows(query.numRowsAffected());
+    if (!shards.empty()) {
+        const int userId = query.lastInsertId().toInt();
+        if (!shardFor(userId)->addShardUser(userId, username)) {
+            // The two files share no transaction; undo the main row so the
+            // name can be registered again.
+            query.prepare("DELETE FROM users WHERE id = :id;");
+            query.bindValue(":id", userId);
+            if (!query.exec()) {
+                qDebug() << "Register error:" << query.lastError().text();
+            }
+            return false;
+        }
+    }
     return true;
 }
 
-bool Database::saveGame(int userId, char board[3][3], const QString &result) {
+bool Database::saveGame(int userId, char board[3][3], const QString &result, bool vsAI,
+                        char playerSymbol, const QVector<int> &moves) {
+    if (!shards.empty()) {
+        return shardFor(userId)->saveGame(userId, board, result, vsAI, playerSymbol, moves);
+    }
+    QueryTimer timer(queryStatistics, "saveGame");
+    QSqlDatabase db = connections.connection();
     if (!isValidUserId(userId)) {
         return false;
     }
-    QString boardStr;
-    for (int i = 0; i < 3; ++i)
-        for (int j = 0; j < 3; ++j)
-            boardStr += board[i][j];
-    QSqlQuery query;
-    query.prepare("INSERT INTO games (user_id, board, result, timestamp) VALUES (:user_id, :board, :result, :timestamp);");
+    // SQLite allows one writer at a time; waiting here is cheaper than
+    // retrying SQLITE_BUSY inside the transaction.
+    QMutexLocker writeLock(&writeMutex);
+    Outcome outcome = outcomeFor(result, playerSymbol);
+
+    if (!db.transaction()) {
+        qDebug() << "Save game error:" << db.lastError().text();
+        return false;
+    }
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO games (user_id, board_code, result, played_at, vs_ai, player_symbol, outcome, moves) "
+                  "VALUES (:user_id, :board_code, :result, :played_at, :vs_ai, :player_symbol, :outcome, :moves);");
     query.bindValue(":user_id", userId);
-    query.bindValue(":board", boardStr);
+    query.bindValue(":board_code", BoardCodec::encode(board));
     query.bindValue(":result", result);
-    query.bindValue(":timestamp", QDateTime::currentDateTime().toString());
-    if (!query.exec()) {
+    query.bindValue(":played_at", QDateTime::currentMSecsSinceEpoch());
+    query.bindValue(":vs_ai", vsAI ? 1 : 0);
+    query.bindValue(":player_symbol", QString(playerSymbol));
+    query.bindValue(":outcome", static_cast<int>(outcome));
+    query.bindValue(":moves", BoardCodec::packMoves(moves));
+    bool inserted = query.exec();
+    timer.track(query);
+    if (!inserted) {
         qDebug() << "Save game error:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    // Column names come from fixed strings, only the counters are bound.
+    const QString mode = vsAI ? "ai" : "pvp";
+    const char *column = outcome == Win ? "wins" : outcome == Loss ? "losses" : "ties";
+    const int streak = outcome == Win ? 1 : 0;
+    QSqlQuery stats(db);
+    stats.prepare(QString(
+        "INSERT INTO user_stats (user_id, games, %2, current_streak, best_streak, %1_games, %1_%2) "
+        "VALUES (:user_id, 1, 1, :streak, :best, 1, 1) "
+        "ON CONFLICT(user_id) DO UPDATE SET "
+        "games = games + 1, %2 = %2 + 1, %1_games = %1_games + 1, %1_%2 = %1_%2 + 1, "
+        "current_streak = CASE WHEN :win THEN current_streak + 1 ELSE 0 END, "
+        "best_streak = CASE WHEN :won THEN MAX(best_streak, current_streak + 1) ELSE best_streak END;"
+    ).arg(mode, column));
+    stats.bindValue(":user_id", userId);
+    stats.bindValue(":streak", streak);
+    stats.bindValue(":best", streak);
+    stats.bindValue(":win", streak);
+    stats.bindValue(":won", streak);
+    bool counted = stats.exec();
+    timer.track(stats);
+    if (!counted) {
+        qDebug() << "Save game error:" << stats.lastError().text();
+        db.rollback();
         return false;
     }
+
+    QHash<int, PositionStats> counts;
+    countPositions(counts, board, result, playerSymbol, moves);
+    QSqlQuery positions(db);
+    bool positioned = addPositionCounts(positions, counts);
+    timer.track(positions);
+    if (!positioned) {
+        qDebug() << "Save game error:" << positions.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    const QString ratingCol = ratingColumn(vsAI ? AIRating : PvPRating);
+    QSqlQuery rating(db);
+    rating.prepare(QString("SELECT %1 FROM users WHERE id = :user_id;").arg(ratingCol));
+    rating.bindValue(":user_id", userId);
+    if (!rating.exec() || !rating.next()) {
+        qDebug() << "Save game error:" << rating.lastError().text();
+        db.rollback();
+        return false;
+    }
+    double newRating = updatedRating(rating.value(0).toDouble(),
+                                     vsAI ? AIOpponentRating : PvPOpponentRating, outcome);
+    rating.finish();
+    rating.prepare(QString("UPDATE users SET %1 = :rating WHERE id = :user_id;").arg(ratingCol));
+    rating.bindValue(":rating", newRating);
+    rating.bindValue(":user_id", userId);
+    bool rated = rating.exec();
+    timer.track(rating);
+    if (!rated || !db.commit()) {
+        qDebug() << "Save game error:" << rating.lastError().text();
+        db.rollback();
+        return false;
+    }
+    cache.invalidateUser(userId);
+    timer.addRows(1);
     return true;
 }
 
 QString Database::getGameHistory(int userId) {
+    if (!shards.empty()) {
+        return shardFor(userId)->getGameHistory(userId);
+    }
+    QueryTimer timer(queryStatistics, "getGameHistory");
+    QSqlDatabase db = connections.connection();
     QString history;
-    QSqlQuery query;
-    query.prepare("SELECT board, result, timestamp FROM games WHERE user_id = :user_id;");
+    quint64 generation = 0;
+    if (cache.history(userId, 0, &history, &generation)) {
+        return history;
+    }
+    QList<GameRecord> games;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT %1 FROM games WHERE user_id = :user_id ORDER BY played_at, id;").arg(GameColumns));
     query.bindValue(":user_id", userId);
     if (!query.exec()) {
         qDebug() << "Get history error:" << query.lastError().text();
         return "Error retrieving history.";
     }
+    timer.track(query);
+    while (query.next()) {
+        games.append(readGame(query));
+    }
+    timer.addRows(games.size());
+    history = formatHistory(games);
+    cache.putHistory(userId, 0, history, generation);
+    return history;
+}
+
+
+UserStats Database::getUserStats(int userId) {
+    if (!shards.empty()) {
+        return shardFor(userId)->getUserStats(userId);
+    }
+    QueryTimer timer(queryStatistics, "getUserStats");
+    QSqlDatabase db = connections.connection();
+    UserStats stats;
+    quint64 generation = 0;
+    if (cache.stats(userId, &stats, &generation)) {
+        return stats;
+    }
+    QSqlQuery query(db);
+    query.prepare("SELECT games, wins, losses, ties, current_streak, best_streak, "
+                  "ai_games, ai_wins, ai_losses, ai_ties, pvp_games, pvp_wins, pvp_losses, pvp_ties "
+                  "FROM user_stats WHERE user_id = :user_id;");
+    query.bindValue(":user_id", userId);
+    if (!query.exec()) {
+        qDebug() << "Get stats error:" << query.lastError().text();
+        return stats;
+    }
+    timer.track(query);
+    if (query.next()) {
+        timer.addRows(1);
+        stats.totalGames = query.value(0).toInt();
+        stats.wins = query.value(1).toInt();
+        stats.losses = query.value(2).toInt();
+        stats.ties = query.value(3).toInt();
+        stats.currentStreak = query.value(4).toInt();
+        stats.bestStreak = query.value(5).toInt();
+        stats.aiGames = query.value(6).toInt();
+        stats.aiWins = query.value(7).toInt();
+        stats.aiLosses = query.value(8).toInt();
+        stats.aiTies = query.value(9).toInt();
+        stats.pvpGames = query.value(10).toInt();
+        stats.pvpWins = query.value(11).toInt();
+        stats.pvpLosses = query.value(12).toInt();
+        stats.pvpTies = query.value(13).toInt();
+    }
+    cache.putStats(userId, stats, generation);
+    return stats;
+}
+
+QString Database::ratingColumn(RatingPool pool) {
+    return pool == AIRating ? "rating_ai" : "rating_pvp";
+}
+
+QString Database::ratingBucketSql(const QString &rating) {
+    // SQLite has no floor(); CAST truncates towards zero, so negative
+    // fractions and quotients are corrected by one.
+    const QString floored = QString("(CAST(%1 AS INTEGER) - (%1 < CAST(%1 AS INTEGER)))").arg(rating);
+    return QString("((%1 - (%1 < 0) * %2) / %3)").arg(floored).arg(RatingBucketWidth - 1).arg(RatingBucketWidth);
+}
+
+qint64 Database::ratingBucket(double rating) {
+    const qint64 floored = static_cast<qint64>(std::floor(rating));
+    return (floored - (floored < 0 ? RatingBucketWidth - 1 : 0)) / RatingBucketWidth;
+}
+
+double Database::updatedRating(double rating, double opponentRating, Outcome outcome) {
+    double expected = 1.0 / (1.0 + std::pow(10.0, (opponentRating - rating) / 400.0));
+    double score = outcome == Win ? 1.0 : outcome == Tie ? 0.5 : 0.0;
+    return rating + RatingK * (score - expected);
+}
+
+double Database::getRating(int userId, RatingPool pool) {
+    if (!shards.empty()) {
+        return shardFor(userId)->getRating(userId, pool);
+    }
+    QueryTimer timer(queryStatistics, "getRating");
+    QSqlDatabase db = connections.connection();
+    QSqlQuery query(db);
+    query.prepare(QString("SELECT %1 FROM users WHERE id = :user_id;").arg(ratingColumn(pool)));
+    query.bindValue(":user_id", userId);
+    if (!query.exec()) {
+        qDebug() << "Get rating error:" << query.lastError().text();
+        return InitialRating;
+    }
+    timer.track(query);
+    return query.next() ? query.value(0).toDouble() : InitialRating;
+}
+
+QList<RatingEntry> Database::getLeaderboard(RatingPool pool, int limit) {
+    QueryTimer timer(queryStatistics, "getLeaderboard");
+    if (!shards.empty()) {
+        // The overall top `limit` is within the union of each shard's top `limit`.
+        QList<RatingEntry> entries;
+        const QList<QList<RatingEntry>> parts = fanOut<QList<RatingEntry>>(shards, [pool, limit](Database *shard) {
+            return shard->getLeaderboard(pool, limit);
+        });
+        for (const QList<RatingEntry> &part : parts) {
+            entries.append(part);
+        }
+        std::sort(entries.begin(), entries.end(), [](const RatingEntry &a, const RatingEntry &b) {
+            return a.rating != b.rating ? a.rating > b.rating : a.userId < b.userId;
+        });
+        if (limit >= 0 && entries.size() > limit) {
+            entries.erase(entries.begin() + limit, entries.end());
+        }
+        timer.addRows(entries.size());
+        return entries;
+    }
+    QSqlDatabase db = readConnection();
+    QList<RatingEntry> entries;
+    const QString column = ratingColumn(pool);
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT id, username, %1 FROM users ORDER BY %1 DESC, id LIMIT :limit;").arg(column));
+    query.bindValue(":limit", limit);
+    if (!query.exec()) {
+        qDebug() << "Get leaderboard error:" << query.lastError().text();
+        return entries;
+    }
+    timer.track(query);
     while (query.next()) {
-        QString board = query.value(0).toString();
-        QString result = query.value(1).toString();
-        QString timestamp = query.value(2).toString();
-        history += QString("Game at %1: Board: %2, Result: %3\n").arg(timestamp, board, result);
+        RatingEntry entry;
+        entry.userId = query.value(0).toInt();
+        entry.username = query.value(1).toString();
+        entry.rating = query.value(2).toDouble();
+        entries.append(entry);
+    }
+    timer.addRows(entries.size());
+    return entries;
+}
+
+int Database::getRank(int userId, RatingPool pool) {
+    QueryTimer timer(queryStatistics, "getRank");
+    QSqlDatabase db = readConnection();
+    if (!isValidUserId(userId)) {
+        return -1;
     }
-    return history.isEmpty() ? "No games played." : history;
+    if (!shards.empty()) {
+        Database *shard = shardFor(userId);
+        if (!shard->isValidUserId(userId)) {
+            return -1;
+        }
+        const double rating = shard->getRating(userId, pool);
+        qint64 above = 0;
+        const QList<qint64> counts = fanOut<qint64>(shards, [pool, rating](Database *shard) {
+            return shard->countRatingsAbove(pool, rating);
+        });
+        for (qint64 count : counts) {
+            if (count < 0) {
+                return -1;
+            }
+            above += count;
+        }
+        return static_cast<int>(above + 1);
+    }
+    const QString column = ratingColumn(pool);
+    const QString bucket = ratingBucketSql("self." + column);
+    QSqlQuery query(db);
+    // Users in higher buckets come from rating_buckets; only the user's own
+    // bucket is counted through the rating index. No row comes back when the
+    // user is missing from this connection's copy, e.g. a snapshot older than
+    // the registration.
+    query.prepare(QString("SELECT (SELECT COALESCE(SUM(users), 0) FROM rating_buckets"
+                          " WHERE pool = :pool AND bucket > %2)"
+                          " + (SELECT COUNT(*) FROM users WHERE %1 > self.%1 AND %1 < (%2 + 1) * %3) + 1"
+                          " FROM users AS self WHERE self.id = :user_id;")
+                      .arg(column, bucket).arg(RatingBucketWidth));
+    query.bindValue(":pool", int(pool));
+    query.bindValue(":user_id", userId);
+    if (!query.exec()) {
+        qDebug() << "Get rank error:" << query.lastError().text();
+        return -1;
+    }
+    if (!query.next()) {
+        return -1;
+    }
+    timer.track(query);
+    return query.value(0).toInt();
+}
+
+bool Database::recomputeRatings() {
+    if (!shards.empty()) {
+        // Ratings only depend on a user's own games, which never span shards.
+        const QList<bool> results = fanOut<bool>(shards, [](Database *shard) {
+            return shard->recomputeRatings();
+        });
+        return !results.contains(false);
+    }
+    QueryTimer timer(queryStatistics, "recomputeRatings");
+    QMutexLocker writeLock(&writeMutex);
+    QSqlDatabase db = connections.connection();
+    // Games are streamed in chronological order; only one rating pair per user is kept in memory.
+    QHash<int, double> pvp;
+    QHash<int, double> ai;
+    QSqlQuery games(db);
+    games.setForwardOnly(true);
+    if (!games.exec("SELECT user_id, vs_ai, outcome FROM games ORDER BY played_at, id;")) {
+        qDebug() << "Recompute ratings error:" << games.lastError().text();
+        return false;
+    }
+    timer.track(games);
+    while (games.next()) {
+        timer.addRows(1);
+        int userId = games.value(0).toInt();
+        bool vsAI = games.value(1).toInt() != 0;
+        Outcome outcome = static_cast<Outcome>(games.value(2).toInt());
+        QHash<int, double> &ratings = vsAI ? ai : pvp;
+        double current = ratings.value(userId, InitialRating);
+        ratings[userId] = updatedRating(current, vsAI ? AIOpponentRating : PvPOpponentRating, outcome);
+    }
+    games.finish();
+
+    if (!db.transaction()) {
+        qDebug() << "Recompute ratings error:" << db.lastError().text();
+        return false;
+    }
+    QSqlQuery update(db);
+    if (!update.exec(QString("UPDATE users SET rating_pvp = %1, rating_ai = %1;").arg(InitialRating))) {
+        qDebug() << "Recompute ratings error:" << update.lastError().text();
+        db.rollback();
+        return false;
+    }
+    for (RatingPool pool : {PvPRating, AIRating}) {
+        const QHash<int, double> &ratings = pool == AIRating ? ai : pvp;
+        update.prepare(QString("UPDATE users SET %1 = :rating WHERE id = :user_id;").arg(ratingColumn(pool)));
+        for (auto it = ratings.constBegin(); it != ratings.constEnd(); ++it) {
+            update.bindValue(":rating", it.value());
+            update.bindValue(":user_id", it.key());
+            if (!update.exec()) {
+                qDebug() << "Recompute ratings error:" << update.lastError().text();
+                db.rollback();
+                return false;
+            }
+        }
+    }
+    if (!db.commit()) {
+        qDebug() << "Recompute ratings error:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool Database::addPositionCounts(QSqlQuery &query, const QHash<int, PositionStats> &counts) {
+    QVariantList positions, occurrences, xWins, oWins, ties;
+    for (auto it = counts.constBegin(); it != counts.constEnd(); ++it) {
+        positions << it.key();
+        occurrences << it.value().occurrences;
+        xWins << it.value().xWins;
+        oWins << it.value().oWins;
+        ties << it.value().ties;
+    }
+    if (positions.isEmpty()) {
+        return true;
+    }
+    query.prepare("INSERT INTO position_stats (position, occurrences, x_wins, o_wins, ties) VALUES (?, ?, ?, ?, ?) "
+                  "ON CONFLICT(position) DO UPDATE SET "
+                  "occurrences = occurrences + excluded.occurrences, x_wins = x_wins + excluded.x_wins, "
+                  "o_wins = o_wins + excluded.o_wins, ties = ties + excluded.ties;");
+    query.addBindValue(positions);
+    query.addBindValue(occurrences);
+    query.addBindValue(xWins);
+    query.addBindValue(oWins);
+    query.addBindValue(ties);
+    return query.execBatch();
+}
+
+bool Database::rebuildPositionStats() {
+    if (!shards.empty()) {
+        const QList<bool> results = fanOut<bool>(shards, [](Database *shard) {
+            return shard->rebuildPositionStats();
+        });
+        return !results.contains(false);
+    }
+    QueryTimer timer(queryStatistics, "rebuildPositionStats");
+    QMutexLocker writeLock(&writeMutex);
+    QSqlDatabase db = connections.connection();
+    // At most 19683 positions exist, so the aggregate always fits in memory.
+    QHash<int, PositionStats> counts;
+    QSqlQuery games(db);
+    games.setForwardOnly(true);
+    if (!games.exec("SELECT board_code, result, player_symbol, moves FROM games;")) {
+        qDebug() << "Rebuild position stats error:" << games.lastError().text();
+        return false;
+    }
+    timer.track(games);
+    while (games.next()) {
+        timer.addRows(1);
+        char board[3][3];
+        BoardCodec::decode(games.value(0).toInt(), board);
+        QString symbol = games.value(2).toString();
+        countPositions(counts, board, games.value(1).toString(), symbol.isEmpty() ? 'X' : symbol.at(0).toLatin1(),
+                       BoardCodec::unpackMoves(games.value(3).toLongLong()));
+    }
+    games.finish();
+
+    if (!db.transaction()) {
+        qDebug() << "Rebuild position stats error:" << db.lastError().text();
+        return false;
+    }
+    QSqlQuery update(db);
+    if (!update.exec("DELETE FROM position_stats;") || !addPositionCounts(update, counts) || !db.commit()) {
+        qDebug() << "Rebuild position stats error:" << update.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool Database::rebuildUserStats() {
+    if (!shards.empty()) {
+        const QList<bool> results = fanOut<bool>(shards, [](Database *shard) {
+            return shard->rebuildUserStats();
+        });
+        return !results.contains(false);
+    }
+    QueryTimer timer(queryStatistics, "rebuildUserStats");
+    QMutexLocker writeLock(&writeMutex);
+    QSqlDatabase db = connections.connection();
+    // Games removed by retention survive only as totals in game_rollups. A
+    // streak running across the retention cutoff restarts at the oldest
+    // remaining game.
+    QHash<int, UserStats> stats;
+    QSqlQuery games(db);
+    games.setForwardOnly(true);
+    if (!games.exec("SELECT user_id, games, wins, losses, ties, ai_games, ai_wins, ai_losses, ai_ties, "
+                    "pvp_games, pvp_wins, pvp_losses, pvp_ties, best_streak FROM game_rollups;")) {
+        qDebug() << "Rebuild user stats error:" << games.lastError().text();
+        return false;
+    }
+    while (games.next()) {
+        UserStats &s = stats[games.value(0).toInt()];
+        s.totalGames = games.value(1).toInt();
+        s.wins = games.value(2).toInt();
+        s.losses = games.value(3).toInt();
+        s.ties = games.value(4).toInt();
+        s.aiGames = games.value(5).toInt();
+        s.aiWins = games.value(6).toInt();
+        s.aiLosses = games.value(7).toInt();
+        s.aiTies = games.value(8).toInt();
+        s.pvpGames = games.value(9).toInt();
+        s.pvpWins = games.value(10).toInt();
+        s.pvpLosses = games.value(11).toInt();
+        s.pvpTies = games.value(12).toInt();
+        s.bestStreak = games.value(13).toInt();
+    }
+    games.finish();
+
+    // Chronological order so streaks come out as saveGame would have left them.
+    if (!games.exec("SELECT user_id, vs_ai, outcome FROM games ORDER BY played_at, id;")) {
+        qDebug() << "Rebuild user stats error:" << games.lastError().text();
+        return false;
+    }
+    timer.track(games);
+    while (games.next()) {
+        timer.addRows(1);
+        addOutcome(stats[games.value(0).toInt()], games.value(1).toInt() != 0,
+                   static_cast<Outcome>(games.value(2).toInt()));
+    }
+    games.finish();
+
+    if (!db.transaction()) {
+        qDebug() << "Rebuild user stats error:" << db.lastError().text();
+        return false;
+    }
+    QSqlQuery update(db);
+    if (!update.exec("DELETE FROM user_stats;")) {
+        qDebug() << "Rebuild user stats error:" << update.lastError().text();
+        db.rollback();
+        return false;
+    }
+    update.prepare("INSERT INTO user_stats (user_id, games, wins, losses, ties, current_streak, best_streak, "
+                   "ai_games, ai_wins, ai_losses, ai_ties, pvp_games, pvp_wins, pvp_losses, pvp_ties) "
+                   "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);");
+    QVector<QVariantList> columns(15);
+    for (auto it = stats.constBegin(); it != stats.constEnd(); ++it) {
+        const UserStats &s = it.value();
+        const int values[15] = {it.key(), s.totalGames, s.wins, s.losses, s.ties, s.currentStreak, s.bestStreak,
+                                s.aiGames, s.aiWins, s.aiLosses, s.aiTies, s.pvpGames, s.pvpWins, s.pvpLosses, s.pvpTies};
+        for (int i = 0; i < 15; ++i) {
+            columns[i] << values[i];
+        }
+    }
+    for (const QVariantList &column : columns) {
+        update.addBindValue(column);
+    }
+    if ((!stats.isEmpty() && !update.execBatch()) || !db.commit()) {
+        qDebug() << "Rebuild user stats error:" << update.lastError().text();
+        db.rollback();
+        return false;
+    }
+    cache.clear();
+    return true;
+}
+
+RetentionResult Database::applyRetention(const QDateTime &cutoff, int batchSize) {
+    if (!shards.empty()) {
+        RetentionResult total;
+        total.ok = true;
+        const QList<RetentionResult> results = fanOut<RetentionResult>(shards, [cutoff, batchSize](Database *shard) {
+            return shard->applyRetention(cutoff, batchSize);
+        });
+        for (const RetentionResult &result : results) {
+            total.ok = total.ok && result.ok;
+            total.archived += result.archived;
+            total.reclaimedPages += result.reclaimedPages;
+        }
+        return total;
+    }
+    QueryTimer timer(queryStatistics, "applyRetention");
+    QSqlDatabase db = connections.connection();
+    RetentionResult result;
+    struct Rollup {
+        UserStats stats;
+        qint64 firstPlayedAt = 0;
+        qint64 lastPlayedAt = 0;
+    };
+
+    QSqlQuery select(db);
+    select.setForwardOnly(true);
+    QSqlQuery update(db);
+    while (true) {
+        // Each batch is read without the write lock; the lock is only held for
+        // the short transaction that rolls it up and deletes it.
+        select.prepare("SELECT id, user_id, vs_ai, outcome, played_at FROM games "
+                       "WHERE played_at < :cutoff ORDER BY played_at, id LIMIT :limit;");
+        select.bindValue(":cutoff", cutoff.toMSecsSinceEpoch());
+        select.bindValue(":limit", batchSize);
+        if (!select.exec()) {
+            qDebug() << "Retention error:" << select.lastError().text();
+            return result;
+        }
+        timer.track(select);
+        QVariantList ids;
+        QHash<int, Rollup> rollups;
+        while (select.next()) {
+            ids << select.value(0);
+            qint64 playedAt = select.value(4).toLongLong();
+            Rollup &rollup = rollups[select.value(1).toInt()];
+            if (rollup.stats.totalGames == 0) {
+                rollup.firstPlayedAt = playedAt;
+            }
+            rollup.lastPlayedAt = playedAt;
+            addOutcome(rollup.stats, select.value(2).toInt() != 0, static_cast<Outcome>(select.value(3).toInt()));
+        }
+        select.finish();
+        if (ids.isEmpty()) {
+            break;
+        }
+
+        {
+            QMutexLocker writeLock(&writeMutex);
+            if (!db.transaction()) {
+                qDebug() << "Retention error:" << db.lastError().text();
+                return result;
+            }
+            bool ok = update.prepare(
+                "INSERT INTO game_rollups (user_id, games, wins, losses, ties, ai_games, ai_wins, ai_losses, ai_ties, "
+                "pvp_games, pvp_wins, pvp_losses, pvp_ties, best_streak, first_played_at, last_played_at) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, "
+                "COALESCE((SELECT best_streak FROM user_stats WHERE user_id = ?), 0), ?, ?) "
+                "ON CONFLICT(user_id) DO UPDATE SET "
+                "games = games + excluded.games, wins = wins + excluded.wins, "
+                "losses = losses + excluded.losses, ties = ties + excluded.ties, "
+                "ai_games = ai_games + excluded.ai_games, ai_wins = ai_wins + excluded.ai_wins, "
+                "ai_losses = ai_losses + excluded.ai_losses, ai_ties = ai_ties + excluded.ai_ties, "
+                "pvp_games = pvp_games + excluded.pvp_games, pvp_wins = pvp_wins + excluded.pvp_wins, "
+                "pvp_losses = pvp_losses + excluded.pvp_losses, pvp_ties = pvp_ties + excluded.pvp_ties, "
+                "best_streak = MAX(best_streak, excluded.best_streak), "
+                "first_played_at = MIN(first_played_at, excluded.first_played_at), "
+                "last_played_at = MAX(last_played_at, excluded.last_played_at);");
+            for (auto it = rollups.constBegin(); ok && it != rollups.constEnd(); ++it) {
+                const UserStats &s = it->stats;
+                const QVariantList values = {it.key(), s.totalGames, s.wins, s.losses, s.ties,
+                                             s.aiGames, s.aiWins, s.aiLosses, s.aiTies,
+                                             s.pvpGames, s.pvpWins, s.pvpLosses, s.pvpTies,
+                                             it.key(), it->firstPlayedAt, it->lastPlayedAt};
+                for (int i = 0; i < values.size(); ++i) {
+                    update.bindValue(i, values[i]);
+                }
+                ok = update.exec();
+                timer.track(update);
+            }
+            if (ok) {
+                update.prepare("DELETE FROM games WHERE id = ?;");
+                update.addBindValue(ids);
+                ok = update.execBatch();
+            }
+            if (!ok || !db.commit()) {
+                qDebug() << "Retention error:" << update.lastError().text();
+                db.rollback();
+                return result;
+            }
+        }
+        for (auto it = rollups.constBegin(); it != rollups.constEnd(); ++it) {
+            cache.invalidateUser(it.key());
+        }
+        result.archived += ids.size();
+        timer.addRows(ids.size());
+    }
+
+    result.reclaimedPages = reclaimFreePages();
+    result.ok = true;
+    return result;
+}
+
+qint64 Database::reclaimFreePages(int pagesPerStep) {
+    qint64 shardPages = 0;
+    for (const std::unique_ptr<Database> &shard : shards) {
+        shardPages += shard->reclaimFreePages(pagesPerStep);
+    }
+    QueryTimer timer(queryStatistics, "reclaimFreePages");
+    QSqlDatabase db = connections.connection();
+    QSqlQuery query(db);
+    qint64 reclaimed = 0;
+    while (true) {
+        QMutexLocker writeLock(&writeMutex);
+        if (!query.exec("PRAGMA freelist_count;") || !query.next()) {
+            break;
+        }
+        const qint64 before = query.value(0).toLongLong();
+        query.finish();
+        if (before == 0 || !query.exec(QString("PRAGMA incremental_vacuum(%1);").arg(pagesPerStep))) {
+            break;
+        }
+        // Each step of the statement frees one page, so run it to completion.
+        while (query.next()) {
+        }
+        query.finish();
+        if (!query.exec("PRAGMA freelist_count;") || !query.next()) {
+            break;
+        }
+        const qint64 after = query.value(0).toLongLong();
+        query.finish();
+        // Without auto_vacuum = INCREMENTAL the pragma is a no-op.
+        if (after >= before) {
+            break;
+        }
+        reclaimed += before - after;
+    }
+    timer.addRows(reclaimed);
+    return reclaimed + shardPages;
+}
+
+bool Database::enableIncrementalVacuum() {
+    for (const std::unique_ptr<Database> &shard : shards) {
+        if (!shard->enableIncrementalVacuum()) {
+            return false;
+        }
+    }
+    QueryTimer timer(queryStatistics, "enableIncrementalVacuum");
+    QMutexLocker writeLock(&writeMutex);
+    QSqlDatabase db = connections.connection();
+    QSqlQuery query(db);
+    // auto_vacuum can only change on an existing file through a full VACUUM.
+    if (!query.exec("PRAGMA auto_vacuum = INCREMENTAL;") || !query.exec("VACUUM;")) {
+        qDebug() << "Enable incremental vacuum error:" << query.lastError().text();
+        return false;
+    }
+    timer.track(query);
+    return true;
+}
+
+// True when `a` and `b` name the same file, through symlinks or relative
+// paths included.
+static bool isSameFile(const QString &a, const QString &b) {
+    QFileInfo first(a);
+    QFileInfo second(b);
+    if (first.exists() && second.exists()) {
+        return first.canonicalFilePath() == second.canonicalFilePath();
+    }
+    return first.absoluteFilePath() == second.absoluteFilePath();
+}
+
+bool Database::backupTo(const QString &path, int pagesPerStep, int pauseMs) {
+    QueryTimer timer(queryStatistics, "backup");
+    QString snapshotFile;
+    {
+        QMutexLocker locker(&snapshotMutex);
+        snapshotFile = snapshotPath;
+    }
+    for (const QString &inUse : {dbPath, snapshotFile}) {
+        if (!inUse.isEmpty() && inUse != ":memory:" && isSameFile(path, inUse)) {
+            qDebug() << "Backup error: refusing to overwrite" << inUse;
+            return false;
+        }
+    }
+    // The copy goes to a fresh file next to `path` and only replaces it once
+    // complete, so a failed backup keeps the previous one.
+    QTemporaryFile staging(QFileInfo(path).absoluteFilePath() + ".XXXXXX");
+    if (!staging.open()) {
+        qDebug() << "Backup error:" << staging.errorString();
+        return false;
+    }
+    staging.close();
+    const QString stagingPath = staging.fileName();
+
+    QSqlDatabase db = connections.connection();
+    bool ok = false;
+    bool copied = false;
+#ifdef TICTACTOE_HAVE_SQLITE3
+    // Only built when Qt's SQLite driver links the same system libsqlite3;
+    // handing its sqlite3* to another copy of the library is undefined.
+    QVariant handle = db.driver()->handle();
+    sqlite3 *source = nullptr;
+    if (handle.isValid() && qstrcmp(handle.typeName(), "sqlite3*") == 0) {
+        source = *static_cast<sqlite3 *const *>(handle.constData());
+    }
+    if (source) {
+        copied = true;
+        sqlite3 *target = nullptr;
+        sqlite3_backup *backup = nullptr;
+        if (sqlite3_open(QFile::encodeName(stagingPath).constData(), &target) != SQLITE_OK
+                || !(backup = sqlite3_backup_init(target, "main", source, "main"))) {
+            qDebug() << "Backup error:" << sqlite3_errmsg(target);
+        } else {
+            int rc;
+            do {
+                rc = sqlite3_backup_step(backup, pagesPerStep);
+                if (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+                    QThread::msleep(pauseMs);
+                }
+            } while (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED);
+            timer.addRows(sqlite3_backup_pagecount(backup) - sqlite3_backup_remaining(backup));
+            rc = sqlite3_backup_finish(backup);
+            ok = rc == SQLITE_OK;
+            if (!ok) {
+                qDebug() << "Backup error:" << sqlite3_errmsg(target);
+            }
+        }
+        sqlite3_close(target);
+    }
+#else
+    Q_UNUSED(pagesPerStep);
+    Q_UNUSED(pauseMs);
+#endif
+    if (!copied) {
+        // A single statement, but it only holds a read transaction; in WAL mode
+        // saveGame keeps committing while it runs. The target may exist as
+        // long as it is empty.
+        QSqlQuery query(db);
+        query.prepare("VACUUM INTO ?;");
+        query.addBindValue(stagingPath);
+        ok = query.exec();
+        timer.track(query);
+        if (!ok) {
+            qDebug() << "Backup error:" << query.lastError().text();
+        }
+    }
+    if (!ok) {
+        return false;
+    }
+    if (std::rename(QFile::encodeName(stagingPath).constData(), QFile::encodeName(path).constData()) != 0) {
+        qDebug() << "Backup error: cannot replace" << path;
+        return false;
+    }
+    staging.setAutoRemove(false);
+    return true;
+}
+
+QFuture<bool> Database::backupInBackground(const QString &path) {
+    return QtConcurrent::run([this, path]() {
+        return backupTo(path);
+    });
+}
+
+bool Database::enableSnapshot(const QString &path) {
+    {
+        QMutexLocker locker(&snapshotMutex);
+        if (snapshot) {
+            return snapshotPath == path;
+        }
+        snapshotPath = path;
+    }
+    if (!refreshSnapshot()) {
+        return false;
+    }
+    QMutexLocker locker(&snapshotMutex);
+    snapshot.reset(new ConnectionPool(path, connectionName + "_snapshot", ConnectionPool::ReadOnly));
+    return true;
+}
+
+bool Database::refreshSnapshot() {
+    QueryTimer timer(queryStatistics, "refreshSnapshot");
+    QString path;
+    {
+        QMutexLocker locker(&snapshotMutex);
+        path = snapshotPath;
+    }
+    if (path.isEmpty()) {
+        return false;
+    }
+    // Unique per call so concurrent refreshes, in this or another process,
+    // never write to the same staging file.
+    QTemporaryFile stagingFile(QFileInfo(path).absoluteFilePath() + ".XXXXXX");
+    if (!stagingFile.open()) {
+        qDebug() << "Refresh snapshot error:" << stagingFile.errorString();
+        return false;
+    }
+    stagingFile.close();
+    const QString staging = stagingFile.fileName();
+    if (!backupTo(staging)) {
+        return false;
+    }
+    {
+        // The copy inherits WAL mode, which a read-only connection cannot
+        // open without the -wal and -shm files next to it.
+        const QString name = connectionName + "_staging";
+        {
+            QSqlDatabase copy = QSqlDatabase::addDatabase("QSQLITE", name);
+            copy.setDatabaseName(staging);
+            if (copy.open()) {
+                QSqlQuery query(copy);
+                query.exec("PRAGMA journal_mode = DELETE;");
+            }
+            copy.close();
+        }
+        QSqlDatabase::removeDatabase(name);
+    }
+    // rename() replaces the old file atomically; readers still holding it keep
+    // their open copy until they reconnect.
+    if (std::rename(QFile::encodeName(staging).constData(), QFile::encodeName(path).constData()) != 0) {
+        qDebug() << "Refresh snapshot error: cannot replace" << path;
+        return false;
+    }
+    stagingFile.setAutoRemove(false);
+    QMutexLocker locker(&snapshotMutex);
+    if (snapshot) {
+        snapshot->reopenAll();
+    }
+    return true;
+}
+
+bool Database::snapshotEnabled() const {
+    QMutexLocker locker(&snapshotMutex);
+    return snapshot != nullptr;
+}
+
+QSqlDatabase Database::readConnection() {
+    ConnectionPool *pool = nullptr;
+    {
+        QMutexLocker locker(&snapshotMutex);
+        pool = snapshot.get();
+    }
+    // The pool lives as long as this Database once created.
+    return pool ? pool->connection() : connections.connection();
+}
+
+PositionStats Database::getPositionStats(const char board[3][3]) {
+    QueryTimer timer(queryStatistics, "getPositionStats");
+    if (!shards.empty()) {
+        PositionStats total;
+        const QList<PositionStats> parts = fanOut<PositionStats>(shards, [board](Database *shard) {
+            return shard->getPositionStats(board);
+        });
+        for (const PositionStats &part : parts) {
+            total.occurrences += part.occurrences;
+            total.xWins += part.xWins;
+            total.oWins += part.oWins;
+            total.ties += part.ties;
+        }
+        return total;
+    }
+    QSqlDatabase db = connections.connection();
+    PositionStats stats;
+    QSqlQuery query(db);
+    query.prepare("SELECT occurrences, x_wins, o_wins, ties FROM position_stats WHERE position = :position;");
+    query.bindValue(":position", BoardCodec::canonical(BoardCodec::encode(board)));
+    if (!query.exec()) {
+        qDebug() << "Get position stats error:" << query.lastError().text();
+        return stats;
+    }
+    timer.track(query);
+    if (query.next()) {
+        timer.addRows(1);
+        stats.occurrences = query.value(0).toLongLong();
+        stats.xWins = query.value(1).toLongLong();
+        stats.oWins = query.value(2).toLongLong();
+        stats.ties = query.value(3).toLongLong();
+    }
+    return stats;
+}
+
+QList<GameRecord> Database::getGamesBetween(int userId, const QDateTime &from, const QDateTime &to) {
+    if (!shards.empty()) {
+        return shardFor(userId)->getGamesBetween(userId, from, to);
+    }
+    QueryTimer timer(queryStatistics, "getGamesBetween");
+    QSqlDatabase db = connections.connection();
+    QList<GameRecord> games;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT %1 FROM games "
+                          "WHERE user_id = :user_id AND played_at >= :from AND played_at < :to "
+                          "ORDER BY played_at, id;").arg(GameColumns));
+    query.bindValue(":user_id", userId);
+    query.bindValue(":from", from.toMSecsSinceEpoch());
+    query.bindValue(":to", to.toMSecsSinceEpoch());
+    if (!query.exec()) {
+        qDebug() << "Get games error:" << query.lastError().text();
+        return games;
+    }
+    timer.track(query);
+    while (query.next()) {
+        games.append(readGame(query));
+    }
+    timer.addRows(games.size());
+    return games;
+}
+
+static void removeDatabaseFiles(const QString &path) {
+    if (path == ":memory:") {
+        return;
+    }
+    for (const char *suffix : {"", "-wal", "-shm", "-journal"}) {
+        QFile::remove(path + suffix);
+    }
+}
+
+int Database::shardIndex(int userId, int count) {
+    // A fixed integer mix rather than qHash, whose output is free to change
+    // between Qt versions while the shard files outlive them.
+    quint32 h = static_cast<quint32>(userId);
+    h ^= h >> 16;
+    h *= 0x7feb352dU;
+    h ^= h >> 15;
+    h *= 0x846ca68bU;
+    h ^= h >> 16;
+    return static_cast<int>(h % static_cast<quint32>(count));
+}
+
+QString Database::shardPath(int index, int count) const {
+    if (dbPath == ":memory:") {
+        return dbPath;
+    }
+    return QString("%1.shard-%2-of-%3").arg(dbPath).arg(index + 1).arg(count);
+}
+
+Database *Database::shardFor(int userId) const {
+    return shards[shardIndex(userId, static_cast<int>(shards.size()))].get();
+}
+
+void Database::openShards() {
+    QSqlDatabase db = connections.connection();
+    QSqlQuery query(db);
+    if (!query.exec("SELECT value FROM settings WHERE name = 'game_shards';") || !query.next()) {
+        return;
+    }
+    const int count = query.value(0).toInt();
+    query.finish();
+    if (count <= 1 || count > MaxShards) {
+        return;
+    }
+    for (int i = 0; i < count; ++i) {
+        shards.emplace_back(new Database(shardPath(i, count)));
+    }
+}
+
+bool Database::addShardUser(int userId, const QString &username) {
+    QMutexLocker writeLock(&writeMutex);
+    QSqlDatabase db = connections.connection();
+    QSqlQuery query(db);
+    // No password: shards are never used to authenticate.
+    query.prepare("INSERT INTO users (id, username) VALUES (:id, :username);");
+    query.bindValue(":id", userId);
+    query.bindValue(":username", username);
+    if (!query.exec()) {
+        qDebug() << "Register error:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+qint64 Database::countRatingsAbove(RatingPool pool, double rating) {
+    QSqlDatabase db = readConnection();
+    QSqlQuery query(db);
+    const qint64 bucket = ratingBucket(rating);
+    query.prepare(QString("SELECT (SELECT COALESCE(SUM(users), 0) FROM rating_buckets"
+                          " WHERE pool = :pool AND bucket > :bucket)"
+                          " + (SELECT COUNT(*) FROM users WHERE %1 > :rating AND %1 < :upper);")
+                      .arg(ratingColumn(pool)));
+    query.bindValue(":pool", int(pool));
+    query.bindValue(":bucket", bucket);
+    query.bindValue(":rating", rating);
+    query.bindValue(":upper", (bucket + 1) * RatingBucketWidth);
+    if (!query.exec() || !query.next()) {
+        qDebug() << "Get rank error:" << query.lastError().text();
+        return -1;
+    }
+    return query.value(0).toLongLong();
+}
+
+bool Database::copyRowsByUser(Database *source, const QString &select, const QString &table,
+                              const QString &userColumn, const QString &key,
+                              const std::vector<Database *> &targets) {
+    const int batchRows = 5000;
+    QSqlDatabase from = source->connections.connection();
+    QSqlQuery rows(from);
+    rows.setForwardOnly(true);
+    if (!rows.exec(select)) {
+        qDebug() << "Reshard error:" << rows.lastError().text();
+        return false;
+    }
+    const QSqlRecord record = rows.record();
+    QStringList columns;
+    QStringList placeholders;
+    QStringList updates;
+    for (int i = 0; i < record.count(); ++i) {
+        const QString name = record.fieldName(i);
+        columns << name;
+        placeholders << "?";
+        if (name != key) {
+            updates << QString("%1 = excluded.%1").arg(name);
+        }
+    }
+    QString sql = QString("INSERT INTO %1 (%2) VALUES (%3)").arg(table, columns.join(", "), placeholders.join(", "));
+    if (!key.isEmpty()) {
+        sql += QString(" ON CONFLICT(%1) DO UPDATE SET %2").arg(key, updates.join(", "));
+    }
+    sql += ";";
+
+    const int userIndex = record.indexOf(userColumn);
+    const int targetCount = static_cast<int>(targets.size());
+    // One column-wise batch per target, sent with execBatch when full.
+    QVector<QVector<QVariantList>> batches(targetCount, QVector<QVariantList>(columns.size()));
+    auto flush = [&](int target) {
+        if (batches[target][0].isEmpty()) {
+            return true;
+        }
+        QSqlDatabase to = targets[target]->connections.connection();
+        QSqlQuery insert(to);
+        insert.prepare(sql);
+        for (QVariantList &values : batches[target]) {
+            insert.addBindValue(values);
+            values.clear();
+        }
+        if (!insert.execBatch()) {
+            qDebug() << "Reshard error:" << insert.lastError().text();
+            return false;
+        }
+        return true;
+    };
+    while (rows.next()) {
+        const int target = shardIndex(rows.value(userIndex).toInt(), targetCount);
+        for (int column = 0; column < columns.size(); ++column) {
+            batches[target][column].append(rows.value(column));
+        }
+        if (batches[target][0].size() >= batchRows && !flush(target)) {
+            return false;
+        }
+    }
+    for (int target = 0; target < targetCount; ++target) {
+        if (!flush(target)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Database::reshard(int count) {
+    QueryTimer timer(queryStatistics, "reshard");
+    if (count < 1 || count > MaxShards) {
+        qDebug() << "Reshard error: shard count must be between 1 and" << MaxShards;
+        return false;
+    }
+    if (count == shardCount()) {
+        return true;
+    }
+    QMutexLocker writeLock(&writeMutex);
+    const int oldCount = shardCount();
+    std::vector<Database *> sources;
+    if (shards.empty()) {
+        sources.push_back(this);
+    }
+    for (const std::unique_ptr<Database> &shard : shards) {
+        sources.push_back(shard.get());
+    }
+    std::vector<std::unique_ptr<Database>> created;
+    std::vector<Database *> targets;
+    if (count == 1) {
+        targets.push_back(this);
+    }
+    for (int i = 0; count > 1 && i < count; ++i) {
+        // Leftovers of an interrupted reshard are never part of the layout.
+        removeDatabaseFiles(shardPath(i, count));
+        created.emplace_back(new Database(shardPath(i, count)));
+        targets.push_back(created.back().get());
+    }
+    auto discard = [&]() {
+        for (Database *target : targets) {
+            target->connections.connection().rollback();
+        }
+        created.clear();
+        for (int i = 0; count > 1 && i < count; ++i) {
+            removeDatabaseFiles(shardPath(i, count));
+        }
+        return false;
+    };
+
+    for (Database *target : targets) {
+        QSqlDatabase db = target->connections.connection();
+        if (!db.transaction()) {
+            qDebug() << "Reshard error:" << db.lastError().text();
+            return discard();
+        }
+    }
+    if (count == 1) {
+        // Rows left behind in the main file when it was first sharded.
+        QSqlDatabase db = connections.connection();
+        QSqlQuery clear(db);
+        for (const char *table : {"games", "user_stats", "game_rollups"}) {
+            if (!clear.exec(QString("DELETE FROM %1;").arg(table))) {
+                qDebug() << "Reshard error:" << clear.lastError().text();
+                return discard();
+            }
+        }
+    }
+    for (Database *source : sources) {
+        // Game ids restart per target, so only their order is carried over.
+        if (!copyRowsByUser(source, "SELECT id, username, rating_pvp, rating_ai FROM users;",
+                            "users", "id", "id", targets)
+            || !copyRowsByUser(source, "SELECT user_id, board_code, result, played_at, vs_ai, player_symbol, "
+                                       "outcome, moves FROM games ORDER BY id;",
+                               "games", "user_id", QString(), targets)
+            || !copyRowsByUser(source, "SELECT * FROM user_stats;", "user_stats", "user_id", "user_id", targets)
+            || !copyRowsByUser(source, "SELECT * FROM game_rollups;", "game_rollups", "user_id", "user_id",
+                               targets)) {
+            return discard();
+        }
+    }
+    for (Database *target : targets) {
+        QSqlDatabase db = target->connections.connection();
+        if (!db.commit()) {
+            qDebug() << "Reshard error:" << db.lastError().text();
+            return discard();
+        }
+    }
+
+    QSqlDatabase db = connections.connection();
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO settings (name, value) VALUES ('game_shards', :count) "
+                  "ON CONFLICT(name) DO UPDATE SET value = excluded.value;");
+    query.bindValue(":count", count);
+    if (!query.exec()) {
+        qDebug() << "Reshard error:" << query.lastError().text();
+        return discard();
+    }
+    timer.track(query);
+
+    // The new layout is live; what remains is cleanup of the old one.
+    const bool wasSharded = !shards.empty();
+    std::vector<std::unique_ptr<Database>> old;
+    old.swap(shards);
+    shards.swap(created);
+    cache.clear();
+    if (wasSharded) {
+        old.clear();
+        for (int i = 0; i < oldCount; ++i) {
+            removeDatabaseFiles(shardPath(i, oldCount));
+        }
+    } else if (db.transaction()) {
+        for (const char *table : {"games", "user_stats", "game_rollups", "position_stats"}) {
+            query.exec(QString("DELETE FROM %1;").arg(table));
+        }
+        db.commit();
+    }
+    return rebuildPositionStats();
+}
+
+QList<GameRecord> Database::getRecentGames(int userId, int limit, const QDateTime &before, qint64 beforeId) {
+    if (!shards.empty()) {
+        return shardFor(userId)->getRecentGames(userId, limit, before, beforeId);
+    }
+    QueryTimer timer(queryStatistics, "getRecentGames");
+    QSqlDatabase db = connections.connection();
+    QList<GameRecord> games;
+    quint64 generation = 0;
+    if (cache.recentGames(userId, limit, before, beforeId, &games, &generation)) {
+        return games;
+    }
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT %1 FROM games WHERE user_id = :user_id%2 "
+                          "ORDER BY played_at DESC, id DESC LIMIT :limit;")
+                      .arg(GameColumns, before.isValid()
+                           ? " AND (played_at < :before OR (played_at = :same AND id < :id))" : ""));
+    query.bindValue(":user_id", userId);
+    if (before.isValid()) {
+        query.bindValue(":before", before.toMSecsSinceEpoch());
+        query.bindValue(":same", before.toMSecsSinceEpoch());
+        query.bindValue(":id", beforeId);
+    }
+    query.bindValue(":limit", limit);
+    if (!query.exec()) {
+        qDebug() << "Get recent games error:" << query.lastError().text();
+        return games;
+    }
+    timer.track(query);
+    while (query.next()) {
+        games.append(readGame(query));
+    }
+    timer.addRows(games.size());
+    cache.putRecentGames(userId, limit, before, beforeId, games, generation);
+    return games;
+}
+
+const char *const Database::GameColumns = "id, user_id, board_code, result, played_at, vs_ai, player_symbol, outcome, moves";
+
+GameRecord Database::readGame(const QSqlQuery &query) {
+    GameRecord game;
+    game.id = query.value(0).toLongLong();
+    game.userId = query.value(1).toInt();
+    game.board = BoardCodec::toString(query.value(2).toInt());
+    game.result = query.value(3).toString();
+    game.playedAt = QDateTime::fromMSecsSinceEpoch(query.value(4).toLongLong(), Qt::UTC);
+    game.vsAI = query.value(5).toInt() != 0;
+    QString symbol = query.value(6).toString();
+    game.playerSymbol = symbol.isEmpty() ? 'X' : symbol.at(0).toLatin1();
+    game.outcome = query.value(7).toInt();
+    game.moves = BoardCodec::unpackMoves(query.value(8).toLongLong());
+    return game;
 }
@@ -2,21 +2,173 @@
 #define DATABASE_H
 
 #include <QString>
-#include <QSqlDatabase>
+#include <QStringList>
+#include <QList>
+#include <QDateTime>
+#include <QHash>
+#include <QSqlQuery>
+#include <QRecursiveMutex>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <QFuture>
+#include <QMutex>
+#include "Storage.h"
+#include "QueryStats.h"
+#include "ReadCache.h"
+#include "ConnectionPool.h"
 
-class Database {
+struct RetentionResult {
+    bool ok = false;
+    qint64 archived = 0;
+    qint64 reclaimedPages = 0;
+};
+
+struct RatingEntry {
+    int userId = -1;
+    QString username;
+    double rating = 0.0;
+};
+
+// SQLite-backed Storage. Each instance owns a uniquely named connection pool,
+// so several databases (including ":memory:" ones) can be open side by side.
+// Every public method may be called from any thread: each thread queries
+// through its own connection and writes are serialized.
+class Database : public Storage {
 public:
+    enum RatingPool { PvPRating, AIRating };
+
+    static constexpr double InitialRating = 1200.0;
+    // Local PvP games have no stored opponent, so they are rated against a
+    // fixed reference player; the minimax AI never loses and rates high.
+    static constexpr double PvPOpponentRating = 1200.0;
+    static constexpr double AIOpponentRating = 1800.0;
+    static constexpr double RatingK = 32.0;
+
     Database();
-    ~Database();
-    int authenticate(const QString &username, const QString &password);
-    bool registerUser(const QString &username, const QString &password);
-    bool saveGame(int userId, char board[3][3], const QString &result);
-    QString getGameHistory(int userId);
+    explicit Database(const QString &path);
+    ~Database() override;
+    int authenticate(const QString &username, const QString &password) override;
+    bool registerUser(const QString &username, const QString &password) override;
+    bool saveGame(int userId, char board[3][3], const QString &result, bool vsAI = false,
+                  char playerSymbol = 'X', const QVector<int> &moves = {}) override;
+    // History and stats are served from readCache() until saveGame changes them.
+    QString getGameHistory(int userId) override;
+    UserStats getUserStats(int userId) override;
+    // Served from the (user_id, played_at) index.
+    QList<GameRecord> getGamesBetween(int userId, const QDateTime &from, const QDateTime &to) override;
+    // Keyset paging over the same index, so every page costs the same.
+    QList<GameRecord> getRecentGames(int userId, int limit, const QDateTime &before = QDateTime(),
+                                     qint64 beforeId = -1) override;
+    // A primary-key lookup on position_stats, which saveGame keeps current.
+    PositionStats getPositionStats(const char board[3][3]) override;
+    QString path() const { return dbPath; }
+    // $TICTACTOE_DB_PATH if set, otherwise tictactoe.db in the working directory.
+    static QString defaultPath();
+    // Latency histograms and row counts per operation; printed on destruction
+    // when $TICTACTOE_QUERY_STATS is set.
+    QueryStats &queryStats() { return queryStatistics; }
+    ReadCache &readCache() { return cache; }
+    // Connections currently open, one per thread that has used this database.
+    int openConnections() const { return connections.openConnections(); }
+
+    double getRating(int userId, RatingPool pool);
+    QList<RatingEntry> getLeaderboard(RatingPool pool, int limit);
+    // 1 + the number of users rated strictly higher; -1 for unknown users.
+    int getRank(int userId, RatingPool pool);
+    // Ratings are counted per bucket of RatingBucketWidth points, split on
+    // whole rating points so SQL and C++ always agree on a bucket's bounds.
+    static constexpr qint64 RatingBucketWidth = 16;
+    static QString ratingBucketSql(const QString &rating);
+    static qint64 ratingBucket(double rating);
+    bool recomputeRatings();
+    // Rebuilds position_stats from every stored game in one transaction.
+    bool rebuildPositionStats();
+    // Rebuilds user_stats, streaks included, from game_rollups plus a replay
+    // of the remaining games. recomputeRatings and rebuildPositionStats only
+    // see games that are still stored.
+    bool rebuildUserStats();
+
+    // Moves games played before `cutoff` into the per-user game_rollups
+    // totals and deletes them, `batchSize` games per write transaction, then
+    // reclaims the freed pages. user_stats, ratings and position_stats are
+    // already aggregates and stay as they are.
+    RetentionResult applyRetention(const QDateTime &cutoff, int batchSize = 500);
+    // Runs PRAGMA incremental_vacuum in short steps; returns pages freed.
+    qint64 reclaimFreePages(int pagesPerStep = 64);
+    // One-off full VACUUM that switches an older file to incremental auto_vacuum.
+    bool enableIncrementalVacuum();
+
+    // Online copy to `path` through the SQLite backup API, `pagesPerStep`
+    // pages at a time with a short pause between steps so writers are never
+    // held up; a write made mid-copy restarts it. Unless Qt uses the system
+    // SQLite (TICTACTOE_QT_SYSTEM_SQLITE) this is a VACUUM INTO instead.
+    // Refuses the live file and the snapshot; `path` is only replaced once
+    // the copy has succeeded.
+    bool backupTo(const QString &path, int pagesPerStep = 64, int pauseMs = 5);
+    QFuture<bool> backupInBackground(const QString &path);
+
+    // Serves getLeaderboard and getRank from a read-only copy at `path`, so
+    // heavy reads never share a connection or lock with saveGame. The copy is
+    // as fresh as the last refreshSnapshot().
+    bool enableSnapshot(const QString &path);
+    bool refreshSnapshot();
+    bool snapshotEnabled() const;
+
+    // Games, user_stats, ratings and position counts can be split across
+    // shard files by user id (see reshard). Users and passwords stay in the
+    // main file; each shard keeps a copy of its users' rows for ratings.
+    // Per-user calls go to one shard, each with its own connections and write
+    // lock, and cross-shard reads fan out in parallel. Backups, snapshots and
+    // DataTransfer game exports cover the main file only.
+    static constexpr int MaxShards = 64;
+    int shardCount() const { return shards.empty() ? 1 : static_cast<int>(shards.size()); }
+    // Moves every game and per-user aggregate into `count` shards (1 moves
+    // them back into the main file) and records the layout so later opens
+    // find it. Game ids are reassigned. An offline operation: nothing else
+    // may use the database while it runs.
+    bool reshard(int count);
+    static int shardIndex(int userId, int count);
+    static double updatedRating(double rating, double opponentRating, Outcome outcome);
 private:
-    QSqlDatabase db;
-    QString hashPassword(const QString &password);
+    friend class DataTransfer;
+    QString dbPath;
+    QString connectionName;
+    ConnectionPool connections;
+    QRecursiveMutex writeMutex;
+    std::unique_ptr<ConnectionPool> snapshot;
+    QString snapshotPath;
+    mutable QMutex snapshotMutex;
+    QueryStats queryStatistics;
+    ReadCache cache;
+    std::vector<std::unique_ptr<Database>> shards;
+    static QString nextConnectionName();
+    void open();
+    void openShards();
+    QString shardPath(int index, int count) const;
+    Database *shardFor(int userId) const;
+    bool addShardUser(int userId, const QString &username);
+    qint64 countRatingsAbove(RatingPool pool, double rating);
+    // Inserts the rows `select` returns on `source` into `table` on the target
+    // their `userColumn` hashes to, in bound batches. Rows whose `key` already
+    // exists on the target are updated instead. Targets must be inside a
+    // transaction.
+    static bool copyRowsByUser(Database *source, const QString &select, const QString &table,
+                               const QString &userColumn, const QString &key,
+                               const std::vector<Database *> &targets);
+    // The snapshot's connection when one is enabled, otherwise the primary one.
+    QSqlDatabase readConnection();
     bool isValidUserId(int userId);
-    bool isValidUsername(const QString& username);
+    bool migrate();
+    bool runMigration(int version, const QStringList &statements);
+    // Fills `target` from `source` for rows where it is NULL, 1000 rows per
+    // transaction, clearing `source` as it goes. Safe to resume after a crash.
+    bool backfillInBatches(const QString &target, const QString &source,
+                           const std::function<QVariant(const QVariant &)> &convert);
+    static QString ratingColumn(RatingPool pool);
+    static bool addPositionCounts(QSqlQuery &query, const QHash<int, PositionStats> &counts);
+    static const char *const GameColumns;
+    static GameRecord readGame(const QSqlQuery &query);
 
 };
 
@@ -1,7 +1,7 @@
 #include "Game.h"
 #include <algorithm>
 
-Game::Game(Database *db) : db(db), vsAI(false) {
+Game::Game(Storage *db) : db(db), vsAI(false) {
     reset();
 }
 
@@ -14,6 +14,7 @@ bool Game::makeMove(int row, int col, char player) {
     if (row < 0 || row >= 3 || col < 0 || col >= 3 || board[row][col] != ' ')
         return false;
     board[row][col] = player;
+    moves.append(row * 3 + col);
     return true;
 }
 
@@ -35,8 +36,10 @@ void Game::aiMove(char aiSymbol) {
             }
         }
     }
-    if (bestRow != -1 && bestCol != -1)
+    if (bestRow != -1 && bestCol != -1) {
         board[bestRow][bestCol] = aiSymbol;
+        moves.append(bestRow * 3 + bestCol);
+    }
 }
 
 int Game::minimax(char board[3][3], int depth, bool isMax, int alpha, int beta, char aiSymbol, char playerSymbol) {
@@ -97,6 +100,7 @@ void Game::reset() {
     for (int i = 0; i < 3; ++i)
         for (int j = 0; j < 3; ++j)
             board[i][j] = ' ';
+    moves.clear();
 }
 
 void Game::getBoard(char board[3][3]) const {
@@ -1,11 +1,11 @@
 #ifndef GAME_H
 #define GAME_H
 
-#include "Database.h"
+#include "Storage.h"
 
 class Game {
 public:
-    Game(Database *db);
+    Game(Storage *db);
     void startGame(bool vsAI);
     bool makeMove(int row, int col, char player);
     void aiMove(char aiSymbol);
@@ -14,10 +14,13 @@ public:
     void reset();
     bool isVsAI() const { return vsAI; }
     void getBoard(char board[3][3]) const;
+    // Cells played since the last reset, as row * 3 + col.
+    const QVector<int> &moveHistory() const { return moves; }
 private:
     int minimax(char board[3][3], int depth, bool isMax, int alpha, int beta, char aiSymbol, char playerSymbol);
     char board[3][3];
-    Database *db;
+    QVector<int> moves;
+    Storage *db;
     bool vsAI;
 };
 
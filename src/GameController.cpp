@@ -0,0 +1,122 @@
+#include "GameController.h"
+#include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrent>
+
+GameController::GameController(Storage *storage, int userId, QObject *parent)
+    : QObject(parent), storage(storage), userId(userId), game(storage), started(false), asyncAI(false),
+      thinking(false), player('X'), turn('X'), round(0), searchRound(-1) {
+    connect(&aiSearch, &QFutureWatcher<int>::finished, this, [this]() {
+        // A search started before a restart belongs to a board that is gone.
+        if (searchRound != round) {
+            return;
+        }
+        thinking = false;
+        emit aiThinking(false, searchClock.nsecsElapsed());
+        applyAIMove(aiSearch.result());
+    });
+}
+
+GameController::~GameController() {
+    aiSearch.waitForFinished();
+}
+
+void GameController::startGame(bool vsAI, char playerSymbol) {
+    ++round;
+    thinking = false;
+    game.startGame(vsAI);
+    player = playerSymbol;
+    started = true;
+    emit boardReset();
+    setTurn(player);
+}
+
+void GameController::restart() {
+    if (!started) {
+        return;
+    }
+    ++round;
+    thinking = false;
+    game.reset();
+    emit boardReset();
+    setTurn(player);
+}
+
+void GameController::setTurn(char symbol) {
+    turn = symbol;
+    emit turnChanged(turn);
+}
+
+bool GameController::playMove(int row, int col) {
+    if (!started || thinking || !game.makeMove(row, col, turn)) {
+        return false;
+    }
+    const char mover = turn;
+    emit moveApplied(row, col, mover);
+    if (finishIfOver(mover)) {
+        return true;
+    }
+    if (!game.isVsAI()) {
+        setTurn(mover == 'X' ? 'O' : 'X');
+        return true;
+    }
+
+    setTurn(aiSymbol());
+    thinking = true;
+    emit aiThinking(true, 0);
+    // The AI searches a copy, so an asynchronous search never touches the
+    // live board.
+    Game position = game;
+    const char symbol = aiSymbol();
+    searchClock.start();
+    if (asyncAI) {
+        searchRound = round;
+        aiSearch.setFuture(QtConcurrent::run([position, symbol]() {
+            Game search = position;
+            search.aiMove(symbol);
+            return search.moveHistory().last();
+        }));
+        return true;
+    }
+    position.aiMove(symbol);
+    thinking = false;
+    emit aiThinking(false, searchClock.nsecsElapsed());
+    applyAIMove(position.moveHistory().last());
+    return true;
+}
+
+void GameController::applyAIMove(int cell) {
+    const char symbol = aiSymbol();
+    if (!game.makeMove(cell / 3, cell % 3, symbol)) {
+        return;
+    }
+    emit moveApplied(cell / 3, cell % 3, symbol);
+    if (!finishIfOver(symbol)) {
+        setTurn(player);
+    }
+}
+
+bool GameController::finishIfOver(char symbol) {
+    char winner;
+    if (game.checkWin(symbol)) {
+        winner = symbol;
+    } else if (game.isBoardFull()) {
+        winner = ' ';
+    } else {
+        return false;
+    }
+    const QString result = winner == ' ' ? QString("Tie") : QString(winner);
+    if (userId != -1) {
+        char board[3][3];
+        game.getBoard(board);
+        QElapsedTimer write;
+        write.start();
+        storage->saveGame(userId, board, result, game.isVsAI(), player, game.moveHistory());
+        emit resultSaved(result, write.nsecsElapsed());
+    }
+    emit gameOver(winner, result);
+    ++round;
+    game.reset();
+    emit boardReset();
+    setTurn(player);
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef GAMECONTROLLER_H
+#define GAMECONTROLLER_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include "Game.h"
+#include "Storage.h"
+
+// Runs the turn flow of one game with no widgets: it applies moves, lets
+// the AI reply, detects a win or tie, saves the result for a signed-in
+// user and starts the next round in the same mode. Views and other
+// drivers follow it through its signals. The side playing playerSymbol
+// always moves first. Controllers are independent, so several games can run
+// side by side on one storage.
+class GameController : public QObject {
+    Q_OBJECT
+public:
+    // userId -1 plays without saving results.
+    explicit GameController(Storage *storage, int userId = -1, QObject *parent = nullptr);
+    ~GameController() override;
+    void startGame(bool vsAI, char playerSymbol = 'X');
+    // Plays for the side whose turn it is. False if no game has started, the
+    // AI is thinking or the cell is taken; nothing is emitted then.
+    bool playMove(int row, int col);
+    // Clears the board; the game keeps its mode and symbols.
+    void restart();
+    // By default the AI replies inside playMove. When asynchronous, it
+    // searches a copy of the game on a worker thread and moves on return.
+    void setAsyncAI(bool on) { asyncAI = on; }
+
+    bool isStarted() const { return started; }
+    bool isVsAI() const { return game.isVsAI(); }
+    bool isAIThinking() const { return thinking; }
+    char playerSymbol() const { return player; }
+    char aiSymbol() const { return player == 'X' ? 'O' : 'X'; }
+    char currentPlayer() const { return turn; }
+    void getBoard(char board[3][3]) const { game.getBoard(board); }
+    const QVector<int> &moveHistory() const { return game.moveHistory(); }
+signals:
+    void moveApplied(int row, int col, char symbol);
+    // The board still holds the final position. winner is ' ' on a tie;
+    // result is what was saved: "X", "O" or "Tie".
+    void gameOver(char winner, const QString &result);
+    // After a finished game or restart() clears the board.
+    void boardReset();
+    void turnChanged(char player);
+    // searchNanos is the search time once thinking is false.
+    void aiThinking(bool thinking, qint64 searchNanos);
+    void resultSaved(const QString &result, qint64 writeNanos);
+private:
+    // Ends the game if `symbol` just won or filled the board.
+    bool finishIfOver(char symbol);
+    void applyAIMove(int cell);
+    void setTurn(char symbol);
+
+    Storage *storage;
+    int userId;
+    Game game;
+    bool started;
+    bool asyncAI;
+    bool thinking;
+    char player;
+    char turn;
+    int round;
+    int searchRound;
+    QElapsedTimer searchClock;
+    QFutureWatcher<int> aiSearch;
+};
+
+#endif
@@ -0,0 +1,327 @@
+#include "GameLog.h"
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QMutexLocker>
+#include <QtConcurrent/QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
+
+namespace {
+const qint64 RecordSize = sizeof(GameLogRecord);
+const qint64 ChecksummedBytes = offsetof(GameLogRecord, checksum);
+
+const quint32 *crcTable() {
+    static quint32 table[256];
+    static bool initialized = [] {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return true;
+    }();
+    Q_UNUSED(initialized);
+    return table;
+}
+
+bool isZero(const GameLogRecord &record) {
+    static const GameLogRecord zero = {};
+    return std::memcmp(&record, &zero, RecordSize) == 0;
+}
+}
+
+GameLog::GameLog(const QString &directory, qint64 recordsPerSegment)
+    : directory(directory), recordsPerSegment(recordsPerSegment), open(false), active(nullptr) {
+    QDir dir(directory);
+    if (!dir.mkpath(".")) {
+        qDebug() << "Game log error: cannot create" << directory;
+        return;
+    }
+    QStringList names = dir.entryList({"segment-*.log"}, QDir::Files, QDir::Name);
+    for (int i = 0; i < names.size(); ++i) {
+        int number = names[i].mid(8, 8).toInt();
+        bool last = i == names.size() - 1;
+        Segment *segment = openSegment(number, last);
+        if (!segment) {
+            return;
+        }
+        segment->sealed = !last;
+        if (segment->sealed) {
+            loadIndex(segment);
+        }
+        segments.append(segment);
+    }
+    if (segments.isEmpty()) {
+        Segment *segment = openSegment(0, true);
+        if (!segment) {
+            return;
+        }
+        segments.append(segment);
+    }
+    active = segments.last();
+    open = true;
+}
+
+GameLog::~GameLog() {
+    compaction.waitForFinished();
+    for (Segment *segment : segments) {
+        if (segment->indexFile) {
+            segment->indexFile->unmap(reinterpret_cast<uchar *>(const_cast<IndexEntry *>(segment->index)));
+            delete segment->indexFile;
+        }
+        segment->file->unmap(segment->data);
+        delete segment->file;
+        delete segment;
+    }
+}
+
+QString GameLog::segmentPath(int number) const {
+    return QDir(directory).filePath(QString("segment-%1.log").arg(number, 8, 10, QChar('0')));
+}
+
+QString GameLog::indexPath(int number) const {
+    return QDir(directory).filePath(QString("segment-%1.idx").arg(number, 8, 10, QChar('0')));
+}
+
+GameLog::Segment *GameLog::openSegment(int number, bool writable) {
+    QFile *file = new QFile(segmentPath(number));
+    if (!file->open(writable ? QIODevice::ReadWrite : QIODevice::ReadOnly)) {
+        qDebug() << "Game log error:" << file->errorString();
+        delete file;
+        return nullptr;
+    }
+    if (writable && file->size() < recordsPerSegment * RecordSize && !file->resize(recordsPerSegment * RecordSize)) {
+        qDebug() << "Game log error:" << file->errorString();
+        delete file;
+        return nullptr;
+    }
+    Segment *segment = new Segment;
+    segment->number = number;
+    segment->file = file;
+    segment->capacity = file->size() / RecordSize;
+    segment->data = segment->capacity > 0 ? file->map(0, segment->capacity * RecordSize) : nullptr;
+    if (segment->capacity > 0 && !segment->data) {
+        qDebug() << "Game log error:" << file->errorString();
+        delete file;
+        delete segment;
+        return nullptr;
+    }
+    recover(segment);
+    if (writable) {
+        // Zero everything past the last valid record: a torn record and any
+        // later pages the kernel happened to flush before the crash.
+        GameLogRecord *records = reinterpret_cast<GameLogRecord *>(segment->data);
+        for (qint64 i = segment->count; i < segment->capacity; ++i) {
+            if (!isZero(records[i])) {
+                std::memset(&records[i], 0, RecordSize);
+            }
+        }
+    }
+    return segment;
+}
+
+void GameLog::recover(Segment *segment) {
+    const GameLogRecord *records = segment->records();
+    qint64 count = 0;
+    while (count < segment->capacity && isValid(records[count])) {
+        ++count;
+    }
+    segment->count = count;
+}
+
+bool GameLog::loadIndex(Segment *segment) {
+    QFile *file = new QFile(indexPath(segment->number));
+    if (!file->exists() || !file->open(QIODevice::ReadOnly)) {
+        delete file;
+        return false;
+    }
+    qint64 entries = file->size() / qint64(sizeof(IndexEntry));
+    uchar *data = entries > 0 ? file->map(0, entries * sizeof(IndexEntry)) : nullptr;
+    if (entries != segment->count || (entries > 0 && !data)) {
+        delete file;
+        return false;
+    }
+    segment->indexFile = file;
+    segment->index = reinterpret_cast<const IndexEntry *>(data);
+    segment->indexCount = entries;
+    return true;
+}
+
+bool GameLog::rollSegment() {
+    Segment *next = openSegment(active->number + 1, true);
+    if (!next) {
+        return false;
+    }
+    QMutexLocker locker(&mutex);
+    active->sealed = true;
+    segments.append(next);
+    active = next;
+    return true;
+}
+
+bool GameLog::append(GameLogRecord record) {
+    if (!open) {
+        return false;
+    }
+    if (active->count == active->capacity && !rollSegment()) {
+        return false;
+    }
+    record.magic = Magic;
+    record.checksum = checksum(record);
+    std::memcpy(active->data + active->count * RecordSize, &record, RecordSize);
+    ++active->count;
+    return true;
+}
+
+qint64 GameLog::size() const {
+    qint64 total = 0;
+    for (const Segment *segment : snapshot()) {
+        total += segment->count;
+    }
+    return total;
+}
+
+int GameLog::segmentCount() const {
+    QMutexLocker locker(&mutex);
+    return segments.size();
+}
+
+QList<GameLog::Segment *> GameLog::snapshot() const {
+    QMutexLocker locker(&mutex);
+    return segments;
+}
+
+QVector<GameLogRecord> GameLog::recordsForUser(quint32 userId) const {
+    QVector<GameLogRecord> result;
+    for (const Segment *segment : snapshot()) {
+        const GameLogRecord *records = segment->records();
+        const IndexEntry *index = nullptr;
+        qint64 indexCount = 0;
+        {
+            QMutexLocker locker(&mutex);
+            index = segment->index;
+            indexCount = segment->indexCount;
+        }
+        if (index) {
+            const IndexEntry *end = index + indexCount;
+            const IndexEntry *it = std::lower_bound(index, end, userId,
+                                                    [](const IndexEntry &e, quint32 id) { return e.userId < id; });
+            for (; it != end && it->userId == userId; ++it) {
+                result.append(records[it->record]);
+            }
+        } else {
+            for (qint64 i = 0; i < segment->count; ++i) {
+                if (records[i].userId == userId) {
+                    result.append(records[i]);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+void GameLog::compact() {
+    QMutexLocker compactionLocker(&compactionMutex);
+    QList<Segment *> pending;
+    {
+        QMutexLocker locker(&mutex);
+        for (Segment *segment : segments) {
+            if (segment->sealed && !segment->index) {
+                pending.append(segment);
+            }
+        }
+    }
+    for (Segment *segment : pending) {
+        QVector<IndexEntry> entries(segment->count);
+        const GameLogRecord *records = segment->records();
+        for (qint64 i = 0; i < segment->count; ++i) {
+            entries[i] = IndexEntry{records[i].userId, quint32(i)};
+        }
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const IndexEntry &a, const IndexEntry &b) { return a.userId < b.userId; });
+
+        QSaveFile out(indexPath(segment->number));
+        if (!out.open(QIODevice::WriteOnly)
+            || out.write(reinterpret_cast<const char *>(entries.constData()), entries.size() * qint64(sizeof(IndexEntry))) < 0
+            || !out.commit()) {
+            qDebug() << "Game log compaction error:" << out.errorString();
+            continue;
+        }
+        QFile *file = new QFile(indexPath(segment->number));
+        uchar *data = nullptr;
+        if (!file->open(QIODevice::ReadOnly) || (segment->count > 0 && !(data = file->map(0, file->size())))) {
+            qDebug() << "Game log compaction error:" << file->errorString();
+            delete file;
+            continue;
+        }
+        QMutexLocker locker(&mutex);
+        segment->indexFile = file;
+        segment->index = reinterpret_cast<const IndexEntry *>(data);
+        segment->indexCount = segment->count;
+    }
+}
+
+QFuture<void> GameLog::compactInBackground() {
+    if (compaction.isRunning()) {
+        return compaction;
+    }
+    compaction = QtConcurrent::run([this]() { compact(); });
+    return compaction;
+}
+
+void GameLog::sync() {
+#ifdef Q_OS_UNIX
+    if (open && active->count > 0) {
+        msync(active->data, active->count * RecordSize, MS_SYNC);
+    }
+#else
+    if (open) {
+        active->file->flush();
+    }
+#endif
+}
+
+GameLogRecord GameLog::makeRecord(quint32 userId, const QVector<int> &moves, quint8 outcome,
+                                  bool vsAI, char playerSymbol, qint64 timestamp) {
+    GameLogRecord record = {};
+    record.userId = userId;
+    const int count = std::min<int>(moves.size(), 16);
+    for (int i = 0; i < count; ++i) {
+        record.packedMoves |= quint64(moves[i] & 0xF) << (4 * i);
+    }
+    record.moveCount = quint8(count);
+    record.outcome = outcome;
+    record.flags = quint8((vsAI ? VsAIFlag : 0) | (playerSymbol == 'O' ? SymbolOFlag : 0));
+    record.timestamp = timestamp;
+    return record;
+}
+
+QVector<int> GameLog::unpackMoves(const GameLogRecord &record) {
+    QVector<int> moves;
+    moves.reserve(record.moveCount);
+    for (int i = 0; i < record.moveCount; ++i) {
+        moves.append(int((record.packedMoves >> (4 * i)) & 0xF));
+    }
+    return moves;
+}
+
+quint32 GameLog::checksum(const GameLogRecord &record) {
+    const quint32 *table = crcTable();
+    const uchar *bytes = reinterpret_cast<const uchar *>(&record);
+    quint32 crc = 0xFFFFFFFFu;
+    for (qint64 i = 0; i < ChecksummedBytes; ++i) {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+bool GameLog::isValid(const GameLogRecord &record) {
+    return record.magic == Magic && record.checksum == checksum(record);
+}
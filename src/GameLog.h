@@ -0,0 +1,108 @@
+#ifndef GAMELOG_H
+#define GAMELOG_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QMutex>
+#include <QFuture>
+
+class QFile;
+
+// Fixed 32-byte on-disk record. The checksum covers the first 28 bytes, so a
+// record torn by a crash mid-write fails validation on the next open.
+struct GameLogRecord {
+    quint32 magic;
+    quint32 userId;
+    quint64 packedMoves;   // 4 bits per move (cell index row * 3 + col), first move lowest
+    qint64 timestamp;      // UTC epoch milliseconds
+    quint8 outcome;        // Storage::Outcome
+    quint8 moveCount;
+    quint8 flags;          // VsAIFlag | SymbolOFlag
+    quint8 reserved;
+    quint32 checksum;
+};
+static_assert(sizeof(GameLogRecord) == 32, "GameLogRecord must stay 32 bytes");
+
+// Append-only, memory-mapped, segmented log of finished games for bulk
+// simulation workloads. Appends are a memcpy into the mapped active segment;
+// sealed segments are immutable and get a sorted (userId, record) sidecar
+// index built by the compactor. One thread appends; compaction may run
+// concurrently on a worker.
+class GameLog {
+public:
+    static constexpr quint32 Magic = 0x47544C47;
+    static constexpr quint8 VsAIFlag = 0x01;
+    static constexpr quint8 SymbolOFlag = 0x02;
+    static constexpr qint64 DefaultRecordsPerSegment = 1 << 21; // 64 MiB segments
+
+    explicit GameLog(const QString &directory, qint64 recordsPerSegment = DefaultRecordsPerSegment);
+    ~GameLog();
+    bool isOpen() const { return open; }
+    bool append(GameLogRecord record);
+    qint64 size() const;
+    int segmentCount() const;
+    // Visits every valid record in append order, straight from the mapped pages.
+    template <typename Fn>
+    void scan(Fn &&fn) const;
+    QVector<GameLogRecord> recordsForUser(quint32 userId) const;
+    // Builds the sidecar index of every sealed segment that lacks one.
+    void compact();
+    QFuture<void> compactInBackground();
+    // Flushes the active segment's dirty pages to disk.
+    void sync();
+
+    static GameLogRecord makeRecord(quint32 userId, const QVector<int> &moves, quint8 outcome,
+                                    bool vsAI, char playerSymbol, qint64 timestamp);
+    static QVector<int> unpackMoves(const GameLogRecord &record);
+    static quint32 checksum(const GameLogRecord &record);
+    static bool isValid(const GameLogRecord &record);
+private:
+    struct IndexEntry {
+        quint32 userId;
+        quint32 record;
+    };
+    struct Segment {
+        int number = 0;
+        QFile *file = nullptr;
+        uchar *data = nullptr;
+        qint64 count = 0;
+        qint64 capacity = 0;
+        bool sealed = false;
+        QFile *indexFile = nullptr;
+        const IndexEntry *index = nullptr;
+        qint64 indexCount = 0;
+        const GameLogRecord *records() const { return reinterpret_cast<const GameLogRecord *>(data); }
+    };
+
+    Segment *openSegment(int number, bool writable);
+    void recover(Segment *segment);
+    bool loadIndex(Segment *segment);
+    bool rollSegment();
+    QString segmentPath(int number) const;
+    QString indexPath(int number) const;
+    QList<Segment *> snapshot() const;
+
+    QString directory;
+    qint64 recordsPerSegment;
+    bool open;
+    QList<Segment *> segments;
+    Segment *active;
+    mutable QMutex mutex;
+    QMutex compactionMutex;
+    QFuture<void> compaction;
+};
+
+template <typename Fn>
+void GameLog::scan(Fn &&fn) const {
+    const QList<Segment *> segs = snapshot();
+    for (const Segment *segment : segs) {
+        const GameLogRecord *records = segment->records();
+        const qint64 count = segment->count;
+        for (qint64 i = 0; i < count; ++i) {
+            fn(records[i]);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,65 @@
+#include "HistoryDelegate.h"
+#include "HistoryModel.h"
+#include <QPainter>
+
+static const int ThumbnailSide = HistoryDelegate::RowHeight - 8;
+
+HistoryDelegate::HistoryDelegate(QObject *parent) : QStyledItemDelegate(parent), thumbnails(1024) {
+}
+
+QSize HistoryDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const {
+    Q_UNUSED(index);
+    return QSize(option.rect.width(), RowHeight);
+}
+
+QPixmap HistoryDelegate::thumbnail(const QString &board, qreal ratio) const {
+    // At most 3^9 distinct boards exist, and most histories repeat a few.
+    const QString key = board + QString::number(ratio);
+    if (QPixmap *cached = thumbnails.object(key)) {
+        return *cached;
+    }
+    QPixmap *pixmap = new QPixmap(QSize(ThumbnailSide, ThumbnailSide) * ratio);
+    pixmap->setDevicePixelRatio(ratio);
+    pixmap->fill(QColor(20, 20, 40, 178));
+    QPainter painter(pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    const qreal cell = ThumbnailSide / 3.0;
+    painter.setPen(QPen(QColor(0xbb, 0x00, 0xff), 1));
+    for (int k = 1; k < 3; ++k) {
+        painter.drawLine(QPointF(k * cell, 0), QPointF(k * cell, ThumbnailSide));
+        painter.drawLine(QPointF(0, k * cell), QPointF(ThumbnailSide, k * cell));
+    }
+    for (int i = 0; i < 9 && i < board.size(); ++i) {
+        const QRectF box((i % 3) * cell + 3, (i / 3) * cell + 3, cell - 6, cell - 6);
+        if (board.at(i) == 'X') {
+            painter.setPen(QPen(QColor(0x00, 0xea, 0xff), 2));
+            painter.drawLine(box.topLeft(), box.bottomRight());
+            painter.drawLine(box.topRight(), box.bottomLeft());
+        } else if (board.at(i) == 'O') {
+            painter.setPen(QPen(QColor(0xff, 0x00, 0xcc), 2));
+            painter.drawEllipse(box);
+        }
+    }
+    painter.end();
+    const QPixmap result = *pixmap;
+    thumbnails.insert(key, pixmap);
+    return result;
+}
+
+void HistoryDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const {
+    painter->save();
+    if (option.state & QStyle::State_Selected) {
+        painter->fillRect(option.rect, QColor(60, 60, 90, 204));
+    } else if (option.state & QStyle::State_MouseOver) {
+        painter->fillRect(option.rect, QColor(40, 40, 60, 230));
+    }
+    const QPoint origin = option.rect.topLeft() + QPoint(4, (option.rect.height() - ThumbnailSide) / 2);
+    painter->drawPixmap(origin, thumbnail(index.data(HistoryModel::BoardRole).toString(),
+                                          painter->device()->devicePixelRatioF()));
+    const QRect text = option.rect.adjusted(ThumbnailSide + 16, 0, -8, 0);
+    painter->setPen(QColor(0xe0, 0xe0, 0xff));
+    painter->drawText(text, Qt::AlignVCenter | Qt::AlignLeft, index.data(Qt::DisplayRole).toString());
+    painter->setPen(QColor(0xbb, 0x00, 0xff));
+    painter->drawLine(option.rect.bottomLeft(), option.rect.bottomRight());
+    painter->restore();
+}
@@ -0,0 +1,25 @@
+#ifndef HISTORYDELEGATE_H
+#define HISTORYDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QCache>
+#include <QPixmap>
+
+// Draws a HistoryModel row as a board thumbnail followed by its text. Rows
+// have one fixed height so a list view can lay them out without asking each
+// one, and thumbnails are cached per final board.
+class HistoryDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+public:
+    static constexpr int RowHeight = 64;
+
+    explicit HistoryDelegate(QObject *parent = nullptr);
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    int cachedThumbnails() const { return thumbnails.count(); }
+private:
+    QPixmap thumbnail(const QString &board, qreal ratio) const;
+    mutable QCache<QString, QPixmap> thumbnails;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "HistoryModel.h"
+#include <QtConcurrent/QtConcurrent>
+
+HistoryModel::HistoryModel(Storage *storage, int userId, int pageSize, QObject *parent)
+    : QAbstractListModel(parent), storage(storage), userId(userId), pageSize(qMax(1, pageSize)), exhausted(false), fetching(false) {
+    connect(&watcher, &QFutureWatcher<QList<GameRecord>>::finished, this, &HistoryModel::appendPage);
+}
+
+HistoryModel::~HistoryModel() {
+    watcher.waitForFinished();
+}
+
+int HistoryModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(games.size());
+}
+
+QVariant HistoryModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= games.size()) {
+        return QVariant();
+    }
+    const GameRecord &game = games.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return QString("%1  %2  %3")
+            .arg(game.playedAt.toLocalTime().toString("yyyy-MM-dd hh:mm"),
+                 game.vsAI ? "VS AI" : "VS PLAYER",
+                 game.outcome == Storage::Win ? "WIN" : game.outcome == Storage::Loss ? "LOSS" : "TIE");
+    case BoardRole:
+        return game.board;
+    case ResultRole:
+        return game.result;
+    case PlayedAtRole:
+        return game.playedAt;
+    case VsAIRole:
+        return game.vsAI;
+    case OutcomeRole:
+        return game.outcome;
+    case MoveCountRole:
+        return static_cast<int>(game.moves.size());
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> HistoryModel::roleNames() const {
+    QHash<int, QByteArray> names = QAbstractListModel::roleNames();
+    names.insert(BoardRole, "board");
+    names.insert(ResultRole, "result");
+    names.insert(PlayedAtRole, "playedAt");
+    names.insert(VsAIRole, "vsAI");
+    names.insert(OutcomeRole, "outcome");
+    names.insert(MoveCountRole, "moveCount");
+    return names;
+}
+
+bool HistoryModel::canFetchMore(const QModelIndex &parent) const {
+    return !parent.isValid() && !exhausted;
+}
+
+void HistoryModel::fetchMore(const QModelIndex &parent) {
+    // Views ask again while a page is in flight; one request at a time.
+    if (parent.isValid() || exhausted || fetching) {
+        return;
+    }
+    fetching = true;
+    Storage *store = storage;
+    const int user = userId;
+    const int limit = pageSize;
+    const QDateTime before = games.isEmpty() ? QDateTime() : games.last().playedAt;
+    const qint64 beforeId = games.isEmpty() ? -1 : games.last().id;
+    watcher.setFuture(QtConcurrent::run([store, user, limit, before, beforeId]() {
+        return store->getRecentGames(user, limit, before, beforeId);
+    }));
+}
+
+void HistoryModel::appendPage() {
+    fetching = false;
+    const QList<GameRecord> page = watcher.result();
+    if (page.size() < pageSize) {
+        exhausted = true;
+    }
+    if (!page.isEmpty()) {
+        beginInsertRows(QModelIndex(), games.size(), games.size() + page.size() - 1);
+        games.append(page);
+        endInsertRows();
+    }
+    emit pageLoaded(page.size());
+}
@@ -0,0 +1,49 @@
+#ifndef HISTORYMODEL_H
+#define HISTORYMODEL_H
+
+#include <QAbstractListModel>
+#include <QFutureWatcher>
+#include <QList>
+#include "Storage.h"
+
+// A user's games, newest first, loaded page by page as a view scrolls. Each
+// fetchMore reads the next page on a worker thread with keyset paging, so
+// the first page shows at once and later pages cost the same however far
+// down the list is. The storage must be safe to call from other threads.
+class HistoryModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    enum Roles {
+        BoardRole = Qt::UserRole + 1,
+        ResultRole,
+        PlayedAtRole,
+        VsAIRole,
+        OutcomeRole,
+        MoveCountRole
+    };
+    static constexpr int DefaultPageSize = 200;
+
+    HistoryModel(Storage *storage, int userId, int pageSize = DefaultPageSize, QObject *parent = nullptr);
+    ~HistoryModel() override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    const GameRecord &game(int row) const { return games.at(row); }
+    bool isFetching() const { return fetching; }
+signals:
+    void pageLoaded(int rows);
+private:
+    void appendPage();
+
+    Storage *storage;
+    int userId;
+    int pageSize;
+    QList<GameRecord> games;
+    bool exhausted;
+    bool fetching;
+    QFutureWatcher<QList<GameRecord>> watcher;
+};
+
+#endif
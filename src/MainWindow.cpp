@@ -2,7 +2,6 @@
 #include "ui_mainwindow.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
-#include <QGridLayout>
 #include <QLabel>
 #include <QPushButton>
 #include <QMessageBox>
@@ -11,19 +10,55 @@
 #include <QListWidgetItem>
 #include <QSizePolicy>
 #include <QApplication>
-#include "AuthWindow.h"
-
-MainWindow::MainWindow(int userId, Database *db, bool testMode, QWidget *parent)
-    : QMainWindow(parent), ui(new Ui::MainWindow), currentUserId(userId), currentPlayer('X'), playerSymbol('X'), db(db), gameStarted(false), m_testMode(testMode) {
+#include <QListView>
+#include "HistoryModel.h"
+#include "HistoryDelegate.h"
+#include "ReplayWindow.h"
+#include "UiDriver.h"
+#include "PerfHud.h"
+#include <QShortcut>
+#include <QTimer>
+#include <QDebug>
+
+MainWindow::MainWindow(int userId, Storage *db, bool testMode, QWidget *parent)
+    : QMainWindow(parent), ui(new Ui::MainWindow), currentUserId(userId), db(db), m_testMode(testMode) {
     
     // FORCE test mode if environment variable is set
     if (qEnvironmentVariableIsSet("TICTACTOE_TEST_MODE")) {
         m_testMode = true;
     }
     
+    setAttribute(Qt::WA_DeleteOnClose);
     ui->setupUi(this);
-    game = new Game(db);
+    controller = new GameController(db, userId, this);
     setupUI();
+
+    perfHud = new PerfHud(this);
+    QShortcut *hudShortcut = new QShortcut(QKeySequence(Qt::Key_F3), this);
+    connect(hudShortcut, &QShortcut::activated, perfHud, &PerfHud::toggle);
+    if (PerfHud::enabledByEnvironment()) {
+        perfHud->setActive(true);
+    }
+
+    connect(controller, &GameController::moveApplied, this, &MainWindow::updateBoard);
+    connect(controller, &GameController::boardReset, this, &MainWindow::updateBoard);
+    connect(controller, &GameController::turnChanged, this, &MainWindow::updatePlayerIndicator);
+    connect(controller, &GameController::gameOver, this, &MainWindow::announceResult);
+    connect(controller, &GameController::aiThinking, perfHud, [this](bool thinking, qint64 searchNanos) {
+        if (!thinking) {
+            perfHud->recordAiSearch(searchNanos);
+        }
+    });
+    connect(controller, &GameController::resultSaved, perfHud, [this](const QString &, qint64 writeNanos) {
+        perfHud->recordDbWrite(writeNanos);
+    });
+
+    if (UiDriver *driver = UiDriver::fromEnvironment(boardView, this)) {
+        connect(driver, &UiDriver::finished, this, [driver]() {
+            qDebug().noquote() << "UI latency, click to repaint:\n" << driver->report();
+        });
+        QTimer::singleShot(0, driver, &UiDriver::start);
+    }
     
     if (m_testMode) {
         setupTestDefaults();
@@ -79,19 +114,13 @@ MainWindow::~MainWindow() {
 }
 
 void MainWindow::setupTestDefaults() {
-    game->startGame(true);
-    playerSymbol = 'X';
-    currentPlayer = 'X';
-    gameStarted = true;
-    modeIndicator->setText("MODE: VS AI");
-    updatePlayerIndicator();
-    
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            cells[i][j]->setEnabled(true);
-        }
-    }
-    updateBoard();
+    beginGame(true, 'X');
+}
+
+void MainWindow::beginGame(bool vsAI, char symbol) {
+    modeIndicator->setText(vsAI ? "MODE: VS AI" : "MODE: VS PLAYER");
+    controller->startGame(vsAI, symbol);
+    boardView->setCellsEnabled(true);
 }
 
 void MainWindow::setupUI() {
@@ -135,17 +164,22 @@ void MainWindow::setupUI() {
     historyButton->setObjectName("historyButton");
     QPushButton *logoutButton = new QPushButton("LOGOUT", this);
     logoutButton->setObjectName("logoutButton");
+    analysisButton = new QPushButton("HINTS", this);
+    analysisButton->setObjectName("analysisButton");
+    analysisButton->setCheckable(true);
 
     vsAIButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
     vsPlayerButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
     restartButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
     historyButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
     logoutButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+    analysisButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
 
     buttonLayout->addWidget(vsAIButton);
     buttonLayout->addWidget(vsPlayerButton);
     buttonLayout->addWidget(restartButton);
     buttonLayout->addWidget(historyButton);
+    buttonLayout->addWidget(analysisButton);
     buttonLayout->addWidget(logoutButton);
 
     mainLayout->addLayout(buttonLayout);
@@ -160,286 +194,147 @@ void MainWindow::setupUI() {
         historyButton->hide(); // Explicitly hide for guest users
     }
 
-    QGridLayout *boardLayout = new QGridLayout();
-    boardLayout->setSpacing(0);
-    boardLayout->setContentsMargins(0, 0, 0, 0);
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            cells[i][j] = new QPushButton("", this);
-            cells[i][j]->setObjectName(QString("cell_%1_%2").arg(i).arg(j));
-            cells[i][j]->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
-            cells[i][j]->setEnabled(false);
-            cells[i][j]->setText("");
-            
-            QString borderStyle;
-            if (i == 0 && j == 0) borderStyle = "border-bottom: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            else if (i == 0 && j == 1) borderStyle = "border-bottom: 1px solid #bb00ff; border-left: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            else if (i == 0 && j == 2) borderStyle = "border-bottom: 1px solid #bb00ff; border-left: 1px solid #bb00ff;";
-            else if (i == 1 && j == 0) borderStyle = "border-top: 1px solid #bb00ff; border-bottom: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            else if (i == 1 && j == 1) borderStyle = "border: 1px solid #bb00ff;";
-            else if (i == 1 && j == 2) borderStyle = "border-top: 1px solid #bb00ff; border-bottom: 1px solid #bb00ff; border-left: 1px solid #bb00ff;";
-            else if (i == 2 && j == 0) borderStyle = "border-top: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            else if (i == 2 && j == 1) borderStyle = "border-top: 1px solid #bb00ff; border-left: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            else if (i == 2 && j == 2) borderStyle = "border-top: 1px solid #bb00ff; border-left: 1px solid #bb00ff;";
-            
-            cells[i][j]->setStyleSheet(
-                QString(
-                    "QPushButton {"
-                    " background-color: rgba(20, 20, 40, 0.7);"
-                    " %1"
-                    " border-radius: 0px;"
-                    " font-size: 40px;"
-                    " font-family: 'Orbitron', 'Arial', sans-serif;"
-                    " color: transparent;"
-                    " margin: 0px;"
-                    " padding: 0px;"
-                    " min-width: 100px;"
-                    " min-height: 100px;"
-                    "}"
-                    "QPushButton:pressed {"
-                    " background-color: rgba(40, 40, 60, 0.7);"
-                    "}"
-                ).arg(borderStyle)
-            );
-            connect(cells[i][j], &QPushButton::clicked, this, [=]() { handleCellClick(i, j); });
-            boardLayout->addWidget(cells[i][j], i, j);
-        }
-    }
-    mainLayout->addLayout(boardLayout, 1);
+    boardView = new BoardView(3, true, this);
+    connect(boardView, &BoardView::cellClicked, this, &MainWindow::handleCellClick);
+    mainLayout->addWidget(boardView, 1);
 
     connect(vsAIButton, &QPushButton::clicked, this, &MainWindow::startGameVsAI);
     connect(vsPlayerButton, &QPushButton::clicked, this, &MainWindow::startGameVsPlayer);
     connect(restartButton, &QPushButton::clicked, this, &MainWindow::restartGame);
     connect(historyButton, &QPushButton::clicked, this, &MainWindow::showHistory);
     connect(logoutButton, &QPushButton::clicked, this, &MainWindow::logout);
+
+    analyzer = new MoveAnalyzer(this);
+    connect(analyzer, &MoveAnalyzer::updated, this, &MainWindow::showAnalysis);
+    connect(analysisButton, &QPushButton::toggled, this, &MainWindow::refreshAnalysis);
 }
 
 void MainWindow::handleCellClick(int row, int col) {
-    if (!gameStarted) {
+    if (!controller->isStarted()) {
         if (!m_testMode) {
             QMessageBox::warning(this, "GAME NOT STARTED", "PLEASE SELECT A GAME MODE!");
         }
         return;
     }
     
-    if (!game->makeMove(row, col, currentPlayer)) {
-        if (!m_testMode) {
+    if (!controller->playMove(row, col)) {
+        if (!m_testMode && !controller->isAIThinking()) {
             QMessageBox::warning(this, "INVALID MOVE", "THIS CELL IS ALREADY TAKEN OR INVALID!");
         }
+    }
+}
+
+void MainWindow::announceResult(char winner) {
+    if (m_testMode) {
         return;
     }
-    
-    updateBoard();
-    if (game->checkWin(currentPlayer)) {
-        char board[3][3];
-        game->getBoard(board);
-        if (!m_testMode) {
-            QMessageBox::information(this, "RESULT", QString("PLAYER %1 WINS!").arg(currentPlayer));
-        }
-        if (currentUserId != -1) {
-            db->saveGame(currentUserId, board, QString(currentPlayer));
-        }
-        game->reset();
-        updateBoard();
-        currentPlayer = playerSymbol;
-        updatePlayerIndicator();
-    } else if (game->isBoardFull()) {
-        char board[3][3];
-        game->getBoard(board);
-        if (!m_testMode) {
-            QMessageBox::information(this, "RESULT", "IT'S A TIE!");
-        }
-        if (currentUserId != -1) {
-            db->saveGame(currentUserId, board, "Tie");
-        }
-        game->reset();
-        updateBoard();
-        currentPlayer = playerSymbol;
-        updatePlayerIndicator();
+    if (winner == ' ') {
+        QMessageBox::information(this, "RESULT", "IT'S A TIE!");
+    } else if (controller->isVsAI() && winner == controller->aiSymbol()) {
+        QMessageBox::information(this, "RESULT", "AI WINS!");
     } else {
-        if (game->isVsAI()) {
-            char aiSymbol = (playerSymbol == 'X') ? 'O' : 'X';
-            game->aiMove(aiSymbol);
-            updateBoard();
-            if (game->checkWin(aiSymbol)) {
-                char board[3][3];
-                game->getBoard(board);
-                if (!m_testMode) {
-                    QMessageBox::information(this, "RESULT", "AI WINS!");
-                }
-                if (currentUserId != -1) {
-                    db->saveGame(currentUserId, board, QString(aiSymbol));
-                }
-                game->reset();
-                updateBoard();
-                currentPlayer = playerSymbol;
-                updatePlayerIndicator();
-            } else if (game->isBoardFull()) {
-                char board[3][3];
-                game->getBoard(board);
-                if (!m_testMode) {
-                    QMessageBox::information(this, "RESULT", "IT'S A TIE!");
-                }
-                if (currentUserId != -1) {
-                    db->saveGame(currentUserId, board, "Tie");
-                }
-                game->reset();
-                updateBoard();
-                currentPlayer = playerSymbol;
-                updatePlayerIndicator();
-            } else {
-                currentPlayer = playerSymbol;
-                updatePlayerIndicator();
-            }
-        } else {
-            currentPlayer = (currentPlayer == playerSymbol) ? (playerSymbol == 'X' ? 'O' : 'X') : playerSymbol;
-            updatePlayerIndicator();
-        }
+        QMessageBox::information(this, "RESULT", QString("PLAYER %1 WINS!").arg(winner));
     }
 }
 
 void MainWindow::updateBoard() {
     char board[3][3] = {{' ', ' ', ' '}, {' ', ' ', ' '}, {' ', ' ', ' '}};
-    game->getBoard(board);
+    controller->getBoard(board);
+    boardView->setBoard(board);
+    refreshAnalysis();
+}
+
+void MainWindow::refreshAnalysis() {
+    // Any position change cancels the analysis of the previous one.
+    boardView->clearHints();
+    if (!analysisButton->isChecked() || !controller->isStarted()) {
+        analyzer->cancel();
+        return;
+    }
+    char board[3][3];
+    controller->getBoard(board);
+    QVector<char> marks;
+    int placed = 0;
     for (int i = 0; i < 3; ++i) {
         for (int j = 0; j < 3; ++j) {
-            QString text = QString(board[i][j]);
-            cells[i][j]->setText(text == " " ? "" : text);
-            QString borderStyle;
-            if (i == 0 && j == 0) borderStyle = "border-bottom: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            else if (i == 0 && j == 1) borderStyle = "border-bottom: 1px solid #bb00ff; border-left: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            else if (i == 0 && j == 2) borderStyle = "border-bottom: 1px solid #bb00ff; border-left: 1px solid #bb00ff;";
-            else if (i == 1 && j == 0) borderStyle = "border-top: 1px solid #bb00ff; border-bottom: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            else if (i == 1 && j == 1) borderStyle = "border: 1px solid #bb00ff;";
-            else if (i == 1 && j == 2) borderStyle = "border-top: 1px solid #bb00ff; border-bottom: 1px solid #bb00ff; border-left: 1px solid #bb00ff;";
-            else if (i == 2 && j == 0) borderStyle = "border-top: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            else if (i == 2 && j == 1) borderStyle = "border-top: 1px solid #bb00ff; border-left: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            else if (i == 2 && j == 2) borderStyle = "border-top: 1px solid #bb00ff; border-left: 1px solid #bb00ff;";
-            
-            if (text == "X") {
-                cells[i][j]->setStyleSheet(
-                    QString(
-                        "QPushButton {"
-                        " background-color: rgba(20, 20, 40, 0.7);"
-                        " %1"
-                        " border-radius: 0px;"
-                        " font-size: 40px;"
-                        " font-family: 'Orbitron', 'Arial', sans-serif;"
-                        " color: #00eaff;"
-                        " margin: 0px;"
-                        " padding: 0px;"
-                        " min-width: 100px;"
-                        " min-height: 100px;"
-                        "}"
-                    ).arg(borderStyle)
-                );
-            } else if (text == "O") {
-                cells[i][j]->setStyleSheet(
-                    QString(
-                        "QPushButton {"
-                        " background-color: rgba(20, 20, 40, 0.7);"
-                        " %1"
-                        " border-radius: 0px;"
-                        " font-size: 40px;"
-                        " font-family: 'Orbitron', 'Arial', sans-serif;"
-                        " color: #ff00cc;"
-                        " margin: 0px;"
-                        " padding: 0px;"
-                        " min-width: 100px;"
-                        " min-height: 100px;"
-                        "}"
-                    ).arg(borderStyle)
-                );
-            } else {
-                cells[i][j]->setStyleSheet(
-                    QString(
-                        "QPushButton {"
-                        " background-color: rgba(20, 20, 40, 0.7);"
-                        " %1"
-                        " border-radius: 0px;"
-                        " font-size: 40px;"
-                        " font-family: 'Orbitron', 'Arial', sans-serif;"
-                        " color: transparent;"
-                        " margin: 0px;"
-                        " padding: 0px;"
-                        " min-width: 100px;"
-                        " min-height: 100px;"
-                        "}"
-                        "QPushButton:pressed {"
-                        " background-color: rgba(40, 40, 60, 0.7);"
-                        "}"
-                    ).arg(borderStyle)
-                );
-            }
+            marks.append(board[i][j]);
+            placed += board[i][j] != ' ' ? 1 : 0;
+        }
+    }
+    // The player's symbol always moves first.
+    const char first = controller->playerSymbol();
+    analyzer->analyze(marks, 3, placed % 2 ? (first == 'X' ? 'O' : 'X') : first);
+}
+
+void MainWindow::showAnalysis() {
+    for (const CellEvaluation &evaluation : analyzer->evaluations()) {
+        const int row = evaluation.cell / 3;
+        const int col = evaluation.cell % 3;
+        switch (evaluation.outcome) {
+        case CellEvaluation::Win:
+            boardView->setHint(row, col, QString("WIN %1").arg(evaluation.distance), QColor(0x00, 0xff, 0x88));
+            break;
+        case CellEvaluation::Loss:
+            boardView->setHint(row, col, QString("LOSS %1").arg(evaluation.distance), QColor(0xff, 0x44, 0x66));
+            break;
+        case CellEvaluation::Draw:
+            boardView->setHint(row, col, "DRAW", QColor(0xe0, 0xe0, 0xff));
+            break;
+        case CellEvaluation::Unknown:
+            boardView->setHint(row, col, QString("... %1").arg(analyzer->depth()), QColor(0x88, 0x88, 0xaa));
+            break;
         }
     }
 }
 
 void MainWindow::updatePlayerIndicator() {
-    if (!gameStarted) {
+    if (!controller->isStarted()) {
         playerIndicator->setText("SELECT A GAME MODE");
         playerIndicator->setStyleSheet("font-size: 14px; color: #bb00ff;");
         return;
     }
     
-    if (game->isVsAI()) {
-        playerIndicator->setText(currentPlayer == playerSymbol ? QString("YOUR TURN (%1)").arg(currentPlayer) : QString("AI'S TURN (%1)").arg(playerSymbol == 'X' ? 'O' : 'X'));
+    const char currentPlayer = controller->currentPlayer();
+    if (controller->isVsAI()) {
+        playerIndicator->setText(currentPlayer == controller->playerSymbol() ? QString("YOUR TURN (%1)").arg(currentPlayer) : QString("AI'S TURN (%1)").arg(controller->aiSymbol()));
     } else {
         playerIndicator->setText(QString("PLAYER %1'S TURN").arg(currentPlayer));
     }
-    playerIndicator->setStyleSheet(
-        currentPlayer == 'X' ?
+    // The AI's turn only lasts while it searches; skip the re-polish when
+    // the colour is unchanged.
+    const QString sheet = currentPlayer == 'X' ?
         "font-size: 14px; color: #00eaff;" :
-        "font-size: 14px; color: #ff00cc;"
-    );
+        "font-size: 14px; color: #ff00cc;";
+    if (playerIndicator->styleSheet() != sheet) {
+        playerIndicator->setStyleSheet(sheet);
+    }
 }
 
 void MainWindow::startGameVsAI() {
-    game->startGame(true);
     if (!m_testMode) {
-        showSymbolSelectionDialog();
+        showSymbolSelectionDialog(true);
     } else {
-        playerSymbol = 'X';
-        currentPlayer = 'X';
-        modeIndicator->setText("MODE: VS AI");
-        updateBoard();
-        updatePlayerIndicator();
-        gameStarted = true;
-        for (int i = 0; i < 3; ++i)
-            for (int j = 0; j < 3; ++j)
-                cells[i][j]->setEnabled(true);
+        beginGame(true, 'X');
     }
 }
 
 void MainWindow::startGameVsPlayer() {
-    game->startGame(false);
     if (!m_testMode) {
-        showSymbolSelectionDialog();
+        showSymbolSelectionDialog(false);
     } else {
-        playerSymbol = 'X';
-        currentPlayer = 'X';
-        modeIndicator->setText("MODE: VS PLAYER");
-        updateBoard();
-        updatePlayerIndicator();
-        gameStarted = true;
-        for (int i = 0; i < 3; ++i)
-            for (int j = 0; j < 3; ++j)
-                cells[i][j]->setEnabled(true);
+        beginGame(false, 'X');
     }
 }
 
 void MainWindow::restartGame() {
-    if (!gameStarted) {
+    if (!controller->isStarted()) {
         if (!m_testMode) {
             QMessageBox::warning(this, "GAME NOT STARTED", "PLEASE SELECT A GAME MODE!");
         }
         return;
     }
     
-    game->reset();
-    currentPlayer = playerSymbol;
-    updateBoard();
-    updatePlayerIndicator();
+    controller->restart();
 }
 
 void MainWindow::showModeSelectionDialog() {
@@ -500,7 +395,7 @@ void MainWindow::showModeSelectionDialog() {
     modeDialog->exec();
 }
 
-void MainWindow::showSymbolSelectionDialog() {
+void MainWindow::showSymbolSelectionDialog(bool vsAI) {
     if (m_testMode) return;
     
     QDialog *symbolDialog = new QDialog(this);
@@ -551,27 +446,11 @@ void MainWindow::showSymbolSelectionDialog() {
     layout->addWidget(oButton);
 
     connect(xButton, &QPushButton::clicked, [=]() {
-        playerSymbol = 'X';
-        currentPlayer = 'X';
-        modeIndicator->setText(game->isVsAI() ? "MODE: VS AI" : "MODE: VS PLAYER");
-        updateBoard();
-        updatePlayerIndicator();
-        gameStarted = true;
-        for (int i = 0; i < 3; ++i)
-            for (int j = 0; j < 3; ++j)
-                cells[i][j]->setEnabled(true);
+        beginGame(vsAI, 'X');
         symbolDialog->accept();
     });
     connect(oButton, &QPushButton::clicked, [=]() {
-        playerSymbol = 'O';
-        currentPlayer = 'O';
-        modeIndicator->setText(game->isVsAI() ? "MODE: VS AI" : "MODE: VS PLAYER");
-        updateBoard();
-        updatePlayerIndicator();
-        gameStarted = true;
-        for (int i = 0; i < 3; ++i)
-            for (int j = 0; j < 3; ++j)
-                cells[i][j]->setEnabled(true);
+        beginGame(vsAI, 'O');
         symbolDialog->accept();
     });
 
@@ -585,7 +464,38 @@ void MainWindow::showHistory() {
         QMessageBox::information(this, "INFO", "GAME HISTORY IS NOT AVAILABLE IN GUEST MODE.");
         return;
     }
-    // History dialog implementation...
+
+    QDialog *historyDialog = new QDialog(this);
+    historyDialog->setAttribute(Qt::WA_DeleteOnClose);
+    historyDialog->setWindowTitle("GAME HISTORY");
+    historyDialog->resize(420, 520);
+    QVBoxLayout *layout = new QVBoxLayout(historyDialog);
+    QLabel *hint = new QLabel("DOUBLE-CLICK A GAME TO REPLAY IT", historyDialog);
+    layout->addWidget(hint, 0, Qt::AlignCenter);
+
+    // Only the visible rows are painted, and pages load as the list scrolls.
+    HistoryModel *model = new HistoryModel(db, currentUserId, HistoryModel::DefaultPageSize, historyDialog);
+    QListView *list = new QListView(historyDialog);
+    list->setObjectName("historyList");
+    list->setUniformItemSizes(true);
+    list->setItemDelegate(new HistoryDelegate(list));
+    list->setModel(model);
+    list->setStyleSheet(
+        "QListView {"
+        " background-color: rgba(20, 20, 40, 0.9);"
+        " border: 2px solid #bb00ff;"
+        " font-family: 'Orbitron', 'Arial', sans-serif;"
+        " font-size: 14px;"
+        "}"
+    );
+    layout->addWidget(list);
+    connect(list, &QListView::doubleClicked, this, [this, model](const QModelIndex &index) {
+        ReplayWindow *replay = new ReplayWindow(model->game(index.row()), this);
+        replay->setAttribute(Qt::WA_DeleteOnClose);
+        replay->show();
+    });
+    model->fetchMore(QModelIndex());
+    historyDialog->show();
 }
 
 QString MainWindow::formatBoard(const QString &board) {
@@ -599,16 +509,14 @@ QString MainWindow::formatBoard(const QString &board) {
 
 void MainWindow::logout() {
     if (m_testMode) {
-        AuthWindow *authWindow = new AuthWindow();
-        authWindow->show();
+        emit logoutRequested();
         this->close();
         return;
     }
     
     int choice = QMessageBox::question(this, "CONFIRM LOGOUT", "ARE YOU SURE YOU WANT TO LOGOUT?", QMessageBox::Yes | QMessageBox::No);
     if (choice == QMessageBox::Yes) {
-        AuthWindow *authWindow = new AuthWindow();
-        authWindow->show();
+        emit logoutRequested();
         this->close();
     }
 }
@@ -4,8 +4,11 @@
 #include <QMainWindow>
 #include <QPushButton>
 #include <QLabel>
-#include "Game.h"
-#include "Database.h"
+#include "GameController.h"
+#include "BoardView.h"
+#include "PerfHud.h"
+#include "MoveAnalyzer.h"
+#include "Storage.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -15,9 +18,13 @@ class MainWindow : public QMainWindow {
     Q_OBJECT
 
 public:
-    explicit MainWindow(int userId, Database *db, bool testMode = false, QWidget *parent = nullptr);
+    explicit MainWindow(int userId, Storage *db, bool testMode = false, QWidget *parent = nullptr);
     ~MainWindow();
 
+signals:
+    // Emitted just before the window closes itself on logout.
+    void logoutRequested();
+
 private slots:
     void handleCellClick(int row, int col);
     void startGameVsAI();
@@ -25,31 +32,35 @@ private slots:
     void restartGame();
     void showHistory();
     void logout();
+    void refreshAnalysis();
+    void showAnalysis();
+    void updateBoard();
+    void updatePlayerIndicator();
+    void announceResult(char winner);
 
 private:
     void setupTestDefaults();
     void setupUI();
-    void updateBoard();
-    void updatePlayerIndicator();
+    void beginGame(bool vsAI, char symbol);
     void showModeSelectionDialog();
-    void showSymbolSelectionDialog();
+    void showSymbolSelectionDialog(bool vsAI);
     QString formatBoard(const QString &board);
 
     // UI file
     Ui::MainWindow *ui;
 
     // Custom UI members
-    QPushButton *cells[3][3];
+    BoardView *boardView;
     QLabel *playerIndicator;
     QLabel *modeIndicator;
+    PerfHud *perfHud;
+    QPushButton *analysisButton;
+    MoveAnalyzer *analyzer;
 
     // State
     int currentUserId;
-    char currentPlayer;
-    char playerSymbol;
-    Database *db;
-    Game *game;
-    bool gameStarted;
+    Storage *db;
+    GameController *controller;
     bool m_testMode;
 };
 
@@ -0,0 +1,110 @@
+#include "MemoryStorage.h"
+#include "BoardCodec.h"
+#include "PasswordHasher.h"
+#include <algorithm>
+
+MemoryStorage::MemoryStorage() : nextUserId(1), nextGameId(1) {
+}
+
+int MemoryStorage::authenticate(const QString &username, const QString &password) {
+    User user;
+    {
+        QMutexLocker locker(&mutex);
+        auto it = users.constFind(username);
+        if (it == users.constEnd()) {
+            return -1;
+        }
+        user = *it;
+    }
+    if (!verifyPassword(password, user.passwordHash)) {
+        return -1;
+    }
+    if (PasswordHasher::needsRehash(user.passwordHash)) {
+        const QString hash = hashPassword(password);
+        QMutexLocker locker(&mutex);
+        users[username].passwordHash = hash;
+    }
+    return user.id;
+}
+
+bool MemoryStorage::registerUser(const QString &username, const QString &password) {
+    if (!isValidUsername(username)) {
+        return false;
+    }
+    const QString hash = hashPassword(password);
+    QMutexLocker locker(&mutex);
+    if (users.contains(username)) {
+        return false;
+    }
+    users.insert(username, User{nextUserId++, hash});
+    return true;
+}
+
+bool MemoryStorage::saveGame(int userId, char board[3][3], const QString &result, bool vsAI,
+                             char playerSymbol, const QVector<int> &moves) {
+    QMutexLocker locker(&mutex);
+    if (userId <= 0 || userId >= nextUserId) {
+        return false;
+    }
+    GameRecord game;
+    game.id = nextGameId++;
+    game.userId = userId;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            game.board += board[i][j];
+    game.result = result;
+    game.playedAt = QDateTime::currentDateTimeUtc();
+    game.vsAI = vsAI;
+    game.playerSymbol = playerSymbol;
+    Outcome outcome = outcomeFor(result, playerSymbol);
+    game.outcome = outcome;
+    game.moves = moves;
+    games[userId].append(game);
+
+    countPositions(positions, board, result, playerSymbol, moves);
+
+    addOutcome(stats[userId], vsAI, outcome);
+    return true;
+}
+
+QString MemoryStorage::getGameHistory(int userId) {
+    QMutexLocker locker(&mutex);
+    return formatHistory(games.value(userId));
+}
+
+UserStats MemoryStorage::getUserStats(int userId) {
+    QMutexLocker locker(&mutex);
+    return stats.value(userId);
+}
+
+QList<GameRecord> MemoryStorage::getGamesBetween(int userId, const QDateTime &from, const QDateTime &to) {
+    // Games are appended in time order, so the range is a contiguous slice.
+    QMutexLocker locker(&mutex);
+    const QList<GameRecord> all = games.value(userId);
+    auto first = std::lower_bound(all.cbegin(), all.cend(), from,
+                                  [](const GameRecord &game, const QDateTime &t) { return game.playedAt < t; });
+    auto last = std::lower_bound(first, all.cend(), to,
+                                 [](const GameRecord &game, const QDateTime &t) { return game.playedAt < t; });
+    return QList<GameRecord>(first, last);
+}
+
+QList<GameRecord> MemoryStorage::getRecentGames(int userId, int limit, const QDateTime &before, qint64 beforeId) {
+    QMutexLocker locker(&mutex);
+    const QList<GameRecord> all = games.value(userId);
+    auto end = all.cend();
+    if (before.isValid()) {
+        end = std::lower_bound(all.cbegin(), all.cend(), before, [beforeId](const GameRecord &game, const QDateTime &t) {
+            return game.playedAt < t || (game.playedAt == t && game.id < beforeId);
+        });
+    }
+    QList<GameRecord> page;
+    for (auto it = end; it != all.cbegin() && page.size() < limit;) {
+        page.append(*--it);
+    }
+    return page;
+}
+
+PositionStats MemoryStorage::getPositionStats(const char board[3][3]) {
+    QMutexLocker locker(&mutex);
+    return positions.value(BoardCodec::canonical(BoardCodec::encode(board)));
+}
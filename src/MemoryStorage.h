@@ -0,0 +1,37 @@
+#ifndef MEMORYSTORAGE_H
+#define MEMORYSTORAGE_H
+
+#include <QHash>
+#include <QMutex>
+#include "Storage.h"
+
+// Map-based store with no SQL or file access, for tests and throwaway sessions.
+// A single mutex makes it safe to share with AuthService's worker threads.
+class MemoryStorage : public Storage {
+public:
+    MemoryStorage();
+    int authenticate(const QString &username, const QString &password) override;
+    bool registerUser(const QString &username, const QString &password) override;
+    bool saveGame(int userId, char board[3][3], const QString &result, bool vsAI = false,
+                  char playerSymbol = 'X', const QVector<int> &moves = {}) override;
+    QString getGameHistory(int userId) override;
+    UserStats getUserStats(int userId) override;
+    QList<GameRecord> getGamesBetween(int userId, const QDateTime &from, const QDateTime &to) override;
+    QList<GameRecord> getRecentGames(int userId, int limit, const QDateTime &before = QDateTime(),
+                                     qint64 beforeId = -1) override;
+    PositionStats getPositionStats(const char board[3][3]) override;
+private:
+    struct User {
+        int id = -1;
+        QString passwordHash;
+    };
+    QMutex mutex;
+    QHash<QString, User> users;
+    QHash<int, QList<GameRecord>> games;
+    QHash<int, UserStats> stats;
+    QHash<int, PositionStats> positions;
+    int nextUserId;
+    qint64 nextGameId;
+};
+
+#endif
@@ -0,0 +1,137 @@
+#include "MoveAnalysis.h"
+#include <algorithm>
+
+MoveAnalysis::MoveAnalysis(const QVector<char> &board, int size, int winLength)
+    : board(board), size(size), winLength(winLength > 0 ? winLength : defaultWinLength(size)),
+      filled(0), hitHorizon(false) {
+    for (char symbol : board) {
+        filled += symbol != ' ' ? 1 : 0;
+    }
+}
+
+int MoveAnalysis::emptyCells() const {
+    return static_cast<int>(board.size()) - filled;
+}
+
+bool MoveAnalysis::wins(int cell) const {
+    static const int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    const char symbol = board[cell];
+    const int row = cell / size;
+    const int col = cell % size;
+    for (const auto &direction : directions) {
+        int count = 1;
+        for (int sign : {1, -1}) {
+            int r = row + sign * direction[0];
+            int c = col + sign * direction[1];
+            while (r >= 0 && r < size && c >= 0 && c < size && board[r * size + c] == symbol) {
+                ++count;
+                r += sign * direction[0];
+                c += sign * direction[1];
+            }
+        }
+        if (count >= winLength) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MoveAnalysis::isCandidate(int cell) const {
+    if (board[cell] != ' ') {
+        return false;
+    }
+    if (size <= 5 || filled == 0) {
+        return true;
+    }
+    const int row = cell / size;
+    const int col = cell % size;
+    for (int r = qMax(0, row - 1); r <= qMin(size - 1, row + 1); ++r) {
+        for (int c = qMax(0, col - 1); c <= qMin(size - 1, col + 1); ++c) {
+            if (board[r * size + c] != ' ') {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int MoveAnalysis::search(char toMove, int depth, int alpha, int beta, int ply, const std::atomic_bool &cancelled) {
+    if (cancelled.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+    if (depth == 0) {
+        hitHorizon = true;
+        return 0;
+    }
+    const char other = toMove == 'X' ? 'O' : 'X';
+    int best = -WinScore;
+    bool moved = false;
+    for (int cell = 0; cell < board.size(); ++cell) {
+        if (!isCandidate(cell)) {
+            continue;
+        }
+        moved = true;
+        board[cell] = toMove;
+        ++filled;
+        int score;
+        if (wins(cell)) {
+            score = WinScore - ply;
+        } else if (filled == board.size()) {
+            score = 0;
+        } else {
+            score = -search(other, depth - 1, -beta, -alpha, ply + 1, cancelled);
+        }
+        --filled;
+        board[cell] = ' ';
+        best = std::max(best, score);
+        alpha = std::max(alpha, score);
+        if (alpha >= beta) {
+            break;
+        }
+    }
+    return moved ? best : 0;
+}
+
+QVector<CellEvaluation> MoveAnalysis::evaluate(char toMove, int depth, const std::atomic_bool &cancelled) {
+    const char other = toMove == 'X' ? 'O' : 'X';
+    // Scores this far from WinScore still mean a forced result.
+    const int decided = WinScore - static_cast<int>(board.size()) - 1;
+    QVector<CellEvaluation> result;
+    for (int cell = 0; cell < board.size(); ++cell) {
+        if (board[cell] != ' ') {
+            continue;
+        }
+        CellEvaluation evaluation;
+        evaluation.cell = cell;
+        hitHorizon = false;
+        board[cell] = toMove;
+        ++filled;
+        int score;
+        if (wins(cell)) {
+            score = WinScore - 1;
+        } else if (filled == board.size()) {
+            score = 0;
+        } else {
+            score = -search(other, depth - 1, -WinScore, WinScore, 2, cancelled);
+        }
+        --filled;
+        board[cell] = ' ';
+        if (cancelled.load(std::memory_order_relaxed)) {
+            return {};
+        }
+        if (score >= decided) {
+            evaluation.outcome = CellEvaluation::Win;
+            evaluation.distance = WinScore - score;
+            evaluation.exact = true;
+        } else if (score <= -decided) {
+            evaluation.outcome = CellEvaluation::Loss;
+            evaluation.distance = WinScore + score;
+            evaluation.exact = true;
+        } else if (!hitHorizon) {
+            evaluation.outcome = CellEvaluation::Draw;
+            evaluation.exact = true;
+        }
+        result.append(evaluation);
+    }
+    return result;
+}
@@ -0,0 +1,48 @@
+#ifndef MOVEANALYSIS_H
+#define MOVEANALYSIS_H
+
+#include <QMetaType>
+#include <QVector>
+#include <atomic>
+
+struct CellEvaluation {
+    enum Outcome { Unknown, Win, Draw, Loss };
+    int cell = -1;
+    // From the side to move, assuming best play by both sides afterwards.
+    Outcome outcome = Unknown;
+    // Plies until the win or loss, the move itself included; -1 otherwise.
+    int distance = -1;
+    // False when the search stopped at its depth limit before proving the
+    // result; such cells are reported as Unknown.
+    bool exact = false;
+};
+Q_DECLARE_METATYPE(CellEvaluation)
+
+// Depth-limited negamax with alpha-beta over a size x size board where
+// winLength in a row wins. Every empty cell is searched with a full window,
+// so the value reported for each one is exact whenever it is proven within
+// the depth. Boards larger than 5 x 5 only search cells next to a mark below
+// the root.
+class MoveAnalysis {
+public:
+    static constexpr int WinScore = 100000;
+
+    MoveAnalysis(const QVector<char> &board, int size, int winLength = 0);
+    static int defaultWinLength(int size) { return size <= 5 ? size : 5; }
+    // Evaluates every empty cell for `toMove`, looking `depth` plies ahead
+    // including the move itself. Returns an empty list once `cancelled` is set.
+    QVector<CellEvaluation> evaluate(char toMove, int depth, const std::atomic_bool &cancelled);
+    int emptyCells() const;
+private:
+    int search(char toMove, int depth, int alpha, int beta, int ply, const std::atomic_bool &cancelled);
+    bool wins(int cell) const;
+    bool isCandidate(int cell) const;
+
+    QVector<char> board;
+    int size;
+    int winLength;
+    int filled;
+    bool hitHorizon;
+};
+
+#endif
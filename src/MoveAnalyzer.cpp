@@ -0,0 +1,66 @@
+#include "MoveAnalyzer.h"
+#include <algorithm>
+
+MoveAnalyzer::MoveAnalyzer(QObject *parent)
+    : QObject(parent), generation(0), running(false), latestDepth(0) {
+    // One worker: a cancelled search notices within a node, so the next
+    // position only waits that long.
+    worker.setMaxThreadCount(1);
+}
+
+MoveAnalyzer::~MoveAnalyzer() {
+    cancel();
+    worker.waitForDone();
+}
+
+void MoveAnalyzer::cancel() {
+    if (cancelled) {
+        cancelled->store(true);
+        cancelled.reset();
+    }
+    ++generation;
+    running = false;
+}
+
+void MoveAnalyzer::analyze(const QVector<char> &board, int size, char toMove, int maxDepth) {
+    cancel();
+    latest.clear();
+    latestDepth = 0;
+    if (!board.contains(' ')) {
+        emit finished();
+        return;
+    }
+    running = true;
+    cancelled = std::make_shared<std::atomic_bool>(false);
+    const std::shared_ptr<std::atomic_bool> flag = cancelled;
+    const int run = generation;
+    worker.start([this, board, size, toMove, maxDepth, flag, run]() {
+        MoveAnalysis analysis(board, size);
+        const int deepest = qMin(maxDepth, analysis.emptyCells());
+        for (int depth = 1; depth <= deepest; ++depth) {
+            const QVector<CellEvaluation> evaluations = analysis.evaluate(toMove, depth, *flag);
+            if (flag->load()) {
+                return;
+            }
+            const bool proven = std::all_of(evaluations.cbegin(), evaluations.cend(),
+                                            [](const CellEvaluation &e) { return e.exact; });
+            const bool last = proven || depth == deepest;
+            // Delivered on this object's thread, and dropped if it is gone.
+            QMetaObject::invokeMethod(this, [this, evaluations, depth, last, run]() {
+                if (run != generation) {
+                    return;
+                }
+                latest = evaluations;
+                latestDepth = depth;
+                emit updated(depth);
+                if (last) {
+                    running = false;
+                    emit finished();
+                }
+            }, Qt::QueuedConnection);
+            if (last) {
+                return;
+            }
+        }
+    });
+}
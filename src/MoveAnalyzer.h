@@ -0,0 +1,41 @@
+#ifndef MOVEANALYZER_H
+#define MOVEANALYZER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include "MoveAnalysis.h"
+
+// Evaluates every empty cell of a position on a worker thread, one search
+// depth at a time, and reports each deeper result as it completes, so the
+// first hints appear at once even on boards too large to search fully.
+// Starting a new analysis cancels the one in flight; results from a
+// cancelled position are never reported.
+class MoveAnalyzer : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int MaxDepth = 12;
+
+    explicit MoveAnalyzer(QObject *parent = nullptr);
+    // Cancels and waits for the worker.
+    ~MoveAnalyzer() override;
+    void analyze(const QVector<char> &board, int size, char toMove, int maxDepth = MaxDepth);
+    void cancel();
+    bool isRunning() const { return running; }
+    const QVector<CellEvaluation> &evaluations() const { return latest; }
+    int depth() const { return latestDepth; }
+signals:
+    void updated(int depth);
+    void finished();
+private:
+    QThreadPool worker;
+    std::shared_ptr<std::atomic_bool> cancelled;
+    int generation;
+    bool running;
+    QVector<CellEvaluation> latest;
+    int latestDepth;
+};
+
+#endif
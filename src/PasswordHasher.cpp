@@ -0,0 +1,93 @@
+#include "PasswordHasher.h"
+#include <QMessageAuthenticationCode>
+#include <QCryptographicHash>
+#include <QRandomGenerator>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QtEndian>
+#include <algorithm>
+
+int PasswordHasher::iterations() {
+    bool ok = false;
+    int configured = qEnvironmentVariableIntValue("TICTACTOE_PBKDF2_ITERATIONS", &ok);
+    return ok && configured > 0 ? configured : DefaultIterations;
+}
+
+QByteArray PasswordHasher::pbkdf2(const QByteArray &password, const QByteArray &salt, int iterations, int keyBytes) {
+    QMessageAuthenticationCode mac(QCryptographicHash::Sha256, password);
+    QByteArray key;
+    for (quint32 block = 1; key.size() < keyBytes; ++block) {
+        QByteArray index(4, '\0');
+        qToBigEndian(block, index.data());
+        mac.reset();
+        mac.addData(salt);
+        mac.addData(index);
+        QByteArray u = mac.result();
+        QByteArray t = u;
+        for (int i = 1; i < iterations; ++i) {
+            mac.reset();
+            mac.addData(u);
+            u = mac.result();
+            for (int j = 0; j < t.size(); ++j) {
+                t[j] = char(t[j] ^ u[j]);
+            }
+        }
+        key.append(t);
+    }
+    return key.left(keyBytes);
+}
+
+QString PasswordHasher::hash(const QString &password, int iterations) {
+    QByteArray salt(SaltBytes, '\0');
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32 *>(salt.data()), SaltBytes / sizeof(quint32));
+    QByteArray key = pbkdf2(password.toUtf8(), salt, iterations, KeyBytes);
+    return QString("pbkdf2$sha256$%1$%2$%3")
+        .arg(iterations)
+        .arg(QString::fromLatin1(salt.toBase64()), QString::fromLatin1(key.toBase64()));
+}
+
+bool PasswordHasher::verify(const QString &password, const QString &stored) {
+    if (!stored.startsWith("pbkdf2$")) {
+        QByteArray legacy = QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex();
+        return constantTimeEquals(legacy, stored.toLatin1());
+    }
+    const QStringList parts = stored.split('$');
+    if (parts.size() != 5 || parts[1] != "sha256") {
+        return false;
+    }
+    int storedIterations = parts[2].toInt();
+    QByteArray salt = QByteArray::fromBase64(parts[3].toLatin1());
+    QByteArray key = QByteArray::fromBase64(parts[4].toLatin1());
+    if (storedIterations <= 0 || key.isEmpty()) {
+        return false;
+    }
+    return constantTimeEquals(pbkdf2(password.toUtf8(), salt, storedIterations, key.size()), key);
+}
+
+bool PasswordHasher::needsRehash(const QString &stored, int iterations) {
+    if (!stored.startsWith("pbkdf2$sha256$")) {
+        return true;
+    }
+    return stored.section('$', 2, 2).toInt() < iterations;
+}
+
+int PasswordHasher::calibrate(int targetMillis) {
+    // Time a fixed probe and scale linearly; PBKDF2 cost is proportional to iterations.
+    const int probe = 20000;
+    QElapsedTimer timer;
+    timer.start();
+    pbkdf2("calibration", QByteArray(SaltBytes, 'x'), probe, KeyBytes);
+    qint64 elapsed = std::max<qint64>(timer.nsecsElapsed(), 1);
+    return int(std::max<qint64>(1000, qint64(targetMillis) * 1000000 * probe / elapsed));
+}
+
+bool PasswordHasher::constantTimeEquals(const QByteArray &a, const QByteArray &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    char diff = 0;
+    for (int i = 0; i < a.size(); ++i) {
+        diff |= char(a[i] ^ b[i]);
+    }
+    return diff == 0;
+}
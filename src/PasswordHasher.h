@@ -0,0 +1,29 @@
+#ifndef PASSWORDHASHER_H
+#define PASSWORDHASHER_H
+
+#include <QString>
+#include <QByteArray>
+
+// Salted PBKDF2-HMAC-SHA256 password hashes, stored as
+// "pbkdf2$sha256$<iterations>$<base64 salt>$<base64 key>". Unsalted SHA-256
+// hex digests from older databases still verify, and needsRehash() reports
+// them so callers can upgrade the stored hash after a successful login.
+class PasswordHasher {
+public:
+    static constexpr int DefaultIterations = 200000;
+    static constexpr int SaltBytes = 16;
+    static constexpr int KeyBytes = 32;
+
+    // $TICTACTOE_PBKDF2_ITERATIONS if set, otherwise DefaultIterations.
+    static int iterations();
+    static QString hash(const QString &password, int iterations = PasswordHasher::iterations());
+    static bool verify(const QString &password, const QString &stored);
+    static bool needsRehash(const QString &stored, int iterations = PasswordHasher::iterations());
+    static QByteArray pbkdf2(const QByteArray &password, const QByteArray &salt, int iterations, int keyBytes);
+    // Iteration count that takes about `targetMillis` on this machine.
+    static int calibrate(int targetMillis);
+private:
+    static bool constantTimeEquals(const QByteArray &a, const QByteArray &b);
+};
+
+#endif
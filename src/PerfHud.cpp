@@ -0,0 +1,130 @@
+#include "PerfHud.h"
+#include <QEvent>
+#include <QPainter>
+#include <algorithm>
+
+PerfHud::PerfHud(QWidget *window)
+    : QWidget(window), window(window), active(false), lastProbeMs(0), lagMs(0), frameNanos(0),
+      lastAiNanos(0), lastDbNanos(0) {
+    setObjectName("perfHud");
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    probeTimer.setTimerType(Qt::PreciseTimer);
+    connect(&probeTimer, &QTimer::timeout, this, &PerfHud::probe);
+    connect(&refreshTimer, &QTimer::timeout, this, &PerfHud::refresh);
+    clock.start();
+    setFixedSize(260, 120);
+    move(8, 8);
+    hide();
+}
+
+bool PerfHud::enabledByEnvironment() {
+    return qEnvironmentVariableIsSet("TICTACTOE_PERF_HUD");
+}
+
+void PerfHud::setActive(bool on) {
+    if (on == active) {
+        return;
+    }
+    active = on;
+    if (on) {
+        stalls.clear();
+        frames.clear();
+        lastProbeMs = clock.elapsed();
+        probeTimer.start(ProbeIntervalMs);
+        refreshTimer.start(RefreshIntervalMs);
+        window->installEventFilter(this);
+        refresh();
+        raise();
+        show();
+    } else {
+        probeTimer.stop();
+        refreshTimer.stop();
+        window->removeEventFilter(this);
+        hide();
+    }
+}
+
+void PerfHud::probe() {
+    // A probe due every ProbeIntervalMs that arrives late was held up by
+    // whatever the event loop was running.
+    const qint64 now = clock.elapsed();
+    lagMs = qMax<qint64>(0, now - lastProbeMs - ProbeIntervalMs);
+    lastProbeMs = now;
+    if (lagMs > 0) {
+        stalls.emplace_back(now, lagMs);
+    }
+    expire(stalls);
+}
+
+void PerfHud::expire(std::deque<QPair<qint64, qint64>> &samples) const {
+    const qint64 cutoff = clock.elapsed() - StallWindowMs;
+    while (!samples.empty() && samples.front().first < cutoff) {
+        samples.pop_front();
+    }
+}
+
+qint64 PerfHud::longestStallMs() const {
+    qint64 longest = 0;
+    for (const auto &sample : stalls) {
+        longest = std::max(longest, sample.second);
+    }
+    return longest;
+}
+
+qint64 PerfHud::slowestFrameNanos() const {
+    qint64 slowest = 0;
+    for (const auto &sample : frames) {
+        slowest = std::max(slowest, sample.second);
+    }
+    return slowest;
+}
+
+bool PerfHud::eventFilter(QObject *watched, QEvent *event) {
+    // An UpdateRequest on the top-level window paints every dirty widget,
+    // so timing its delivery times the whole frame.
+    if (watched == window && event->type() == QEvent::UpdateRequest) {
+        QElapsedTimer frame;
+        frame.start();
+        static_cast<QObject *>(window)->event(event);
+        frameNanos = frame.nsecsElapsed();
+        frames.emplace_back(clock.elapsed(), frameNanos);
+        expire(frames);
+        return true;
+    }
+    return false;
+}
+
+QString PerfHud::text() const {
+    const int seconds = StallWindowMs / 1000;
+    return QString("EVENT LOOP LAG  %1 ms\n"
+                   "LONGEST STALL (%2 s)  %3 ms\n"
+                   "FRAME  %4 ms  (WORST %5 ms)\n"
+                   "AI SEARCH  %6 ms\n"
+                   "DB WRITE  %7 ms")
+        .arg(lagMs)
+        .arg(seconds)
+        .arg(longestStallMs())
+        .arg(frameNanos / 1e6, 0, 'f', 2)
+        .arg(slowestFrameNanos() / 1e6, 0, 'f', 2)
+        .arg(lastAiNanos / 1e6, 0, 'f', 2)
+        .arg(lastDbNanos / 1e6, 0, 'f', 2);
+}
+
+void PerfHud::refresh() {
+    expire(stalls);
+    expire(frames);
+    const QString next = text();
+    if (next != lines) {
+        lines = next;
+        update();
+    }
+}
+
+void PerfHud::paintEvent(QPaintEvent *event) {
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(0, 0, 0, 170));
+    painter.setPen(QColor(0x00, 0xff, 0x88));
+    painter.setFont(QFont("monospace", 9));
+    painter.drawText(rect().adjusted(8, 6, -8, -6), Qt::AlignLeft | Qt::AlignTop, lines);
+}
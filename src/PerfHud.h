@@ -0,0 +1,61 @@
+#ifndef PERFHUD_H
+#define PERFHUD_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <deque>
+
+// A small overlay in the corner of a window showing how late the event loop
+// runs, the longest stall and slowest frame in the last StallWindowMs, the
+// last frame time, and the last AI search and database write. While hidden
+// its timers are stopped and nothing is filtered; recordAiSearch and
+// recordDbWrite only store a number.
+class PerfHud : public QWidget {
+    Q_OBJECT
+public:
+    static constexpr int ProbeIntervalMs = 50;
+    static constexpr int RefreshIntervalMs = 500;
+    static constexpr int StallWindowMs = 10000;
+
+    explicit PerfHud(QWidget *window);
+    // Shown at start-up when $TICTACTOE_PERF_HUD is set.
+    static bool enabledByEnvironment();
+    void setActive(bool on);
+    void toggle() { setActive(!active); }
+    bool isActive() const { return active; }
+    void recordAiSearch(qint64 nanos) { lastAiNanos = nanos; }
+    void recordDbWrite(qint64 nanos) { lastDbNanos = nanos; }
+
+    qint64 eventLoopLagMs() const { return lagMs; }
+    qint64 longestStallMs() const;
+    qint64 lastFrameNanos() const { return frameNanos; }
+    qint64 slowestFrameNanos() const;
+    qint64 lastAiSearchNanos() const { return lastAiNanos; }
+    qint64 lastDbWriteNanos() const { return lastDbNanos; }
+    QString text() const;
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
+private:
+    void probe();
+    void refresh();
+    void expire(std::deque<QPair<qint64, qint64>> &samples) const;
+
+    QWidget *window;
+    bool active;
+    QTimer probeTimer;
+    QTimer refreshTimer;
+    QElapsedTimer clock;
+    qint64 lastProbeMs;
+    qint64 lagMs;
+    qint64 frameNanos;
+    qint64 lastAiNanos;
+    qint64 lastDbNanos;
+    // (time ms, value) pairs from the last StallWindowMs.
+    std::deque<QPair<qint64, qint64>> stalls;
+    std::deque<QPair<qint64, qint64>> frames;
+    QString lines;
+};
+
+#endif
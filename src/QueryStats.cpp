@@ -0,0 +1,180 @@
+#include "QueryStats.h"
+#include <QSqlQuery>
+#include <QFile>
+#include <QDateTime>
+#include <QTextStream>
+#include <QDebug>
+#include <algorithm>
+
+void LatencyHistogram::record(qint64 nanos) {
+    if (nanos < 0) nanos = 0;
+    counts[bucketFor(nanos)]++;
+    total++;
+    maxValue = std::max(maxValue, nanos);
+}
+
+void LatencyHistogram::reset() {
+    counts.fill(0);
+    total = 0;
+    maxValue = 0;
+}
+
+int LatencyHistogram::bucketFor(qint64 nanos) {
+    if (nanos < SubBuckets) {
+        return int(nanos);
+    }
+    int magnitude = 63 - qCountLeadingZeroBits(quint64(nanos));
+    int shift = magnitude - SubBucketBits;
+    int sub = int((nanos >> shift) & (SubBuckets - 1));
+    return (shift + 1) * SubBuckets + sub;
+}
+
+qint64 LatencyHistogram::upperBound(int bucket) {
+    if (bucket < SubBuckets) {
+        return bucket;
+    }
+    int shift = bucket / SubBuckets - 1;
+    qint64 lower = qint64(SubBuckets + bucket % SubBuckets) << shift;
+    return lower + (qint64(1) << shift) - 1;
+}
+
+qint64 LatencyHistogram::percentile(double p) const {
+    if (total == 0) {
+        return 0;
+    }
+    qint64 target = std::max<qint64>(1, qint64(total * p / 100.0 + 0.5));
+    qint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += counts[i];
+        if (seen >= target) {
+            return std::min(upperBound(i), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+QueryStats::QueryStats() : slowLogMaxBytes(1 << 20), slowLogMaxFiles(3) {
+    bool ok = false;
+    qint64 threshold = qEnvironmentVariableIntValue("TICTACTOE_SLOW_QUERY_MS", &ok);
+    slowThresholdNanos.storeRelaxed(ok ? threshold * 1000000 : 0);
+    slowLogPath = qEnvironmentVariable("TICTACTOE_SLOW_QUERY_LOG", "tictactoe-slow.log");
+}
+
+void QueryStats::record(QLatin1String operation, qint64 nanos, qint64 rows, const QList<Statement> &statements) {
+    {
+        QMutexLocker locker(&mutex);
+        Operation &op = operations[operation];
+        op.latency.record(nanos);
+        op.rows += rows;
+    }
+    qint64 threshold = slowThresholdNanos.loadRelaxed();
+    if (threshold > 0 && nanos >= threshold) {
+        writeSlowQuery(operation, nanos, statements);
+    }
+}
+
+QList<QueryStats::Summary> QueryStats::summaries() const {
+    QList<Summary> result;
+    QMutexLocker locker(&mutex);
+    for (auto it = operations.constBegin(); it != operations.constEnd(); ++it) {
+        Summary summary;
+        summary.operation = it.key();
+        summary.calls = it->latency.count();
+        summary.rows = it->rows;
+        summary.p50 = it->latency.percentile(50);
+        summary.p99 = it->latency.percentile(99);
+        summary.max = it->latency.max();
+        result.append(summary);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const Summary &a, const Summary &b) { return a.operation < b.operation; });
+    return result;
+}
+
+QString QueryStats::report() const {
+    QString text = QString("%1 %2 %3 %4 %5 %6\n")
+                       .arg("operation", -20).arg("calls", 8).arg("rows", 10)
+                       .arg("p50 ms", 10).arg("p99 ms", 10).arg("max ms", 10);
+    for (const Summary &s : summaries()) {
+        text += QString("%1 %2 %3 %4 %5 %6\n")
+                    .arg(s.operation, -20).arg(s.calls, 8).arg(s.rows, 10)
+                    .arg(s.p50 / 1e6, 10, 'f', 3).arg(s.p99 / 1e6, 10, 'f', 3).arg(s.max / 1e6, 10, 'f', 3);
+    }
+    return text;
+}
+
+void QueryStats::reset() {
+    QMutexLocker locker(&mutex);
+    operations.clear();
+}
+
+void QueryStats::setSlowQueryThreshold(qint64 milliseconds) {
+    slowThresholdNanos.storeRelaxed(milliseconds > 0 ? milliseconds * 1000000 : 0);
+}
+
+void QueryStats::setSlowQueryLog(const QString &path, qint64 maxBytes, int maxFiles) {
+    QMutexLocker locker(&mutex);
+    slowLogPath = path;
+    slowLogMaxBytes = maxBytes;
+    slowLogMaxFiles = std::max(1, maxFiles);
+}
+
+QString QueryStats::bindingShape(const QVariantList &bindings) {
+    // Types and sizes only; bound values may hold password hashes.
+    QStringList shape;
+    for (const QVariant &value : bindings) {
+        if (value.isNull()) {
+            shape << "null";
+        } else if (value.typeId() == QMetaType::QString) {
+            shape << QString("text(%1)").arg(value.toString().size());
+        } else if (value.typeId() == QMetaType::QByteArray) {
+            shape << QString("blob(%1)").arg(value.toByteArray().size());
+        } else {
+            shape << QString::fromLatin1(value.typeName());
+        }
+    }
+    return "[" + shape.join(", ") + "]";
+}
+
+void QueryStats::writeSlowQuery(QLatin1String operation, qint64 nanos, const QList<Statement> &statements) {
+    QMutexLocker locker(&mutex);
+    rotateSlowLog();
+    QFile file(slowLogPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qDebug() << "Slow query log error:" << file.errorString();
+        return;
+    }
+    QTextStream out(&file);
+    out << QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs) << " "
+        << operation << " " << QString::number(nanos / 1e6, 'f', 3) << " ms\n";
+    for (const Statement &statement : statements) {
+        out << "    " << statement.sql << " " << bindingShape(statement.bindings) << "\n";
+    }
+}
+
+void QueryStats::rotateSlowLog() {
+    QFile current(slowLogPath);
+    if (!current.exists() || current.size() < slowLogMaxBytes) {
+        return;
+    }
+    QFile::remove(QString("%1.%2").arg(slowLogPath).arg(slowLogMaxFiles));
+    for (int i = slowLogMaxFiles - 1; i >= 1; --i) {
+        QFile::rename(QString("%1.%2").arg(slowLogPath).arg(i), QString("%1.%2").arg(slowLogPath).arg(i + 1));
+    }
+    QFile::rename(slowLogPath, slowLogPath + ".1");
+}
+
+QueryTimer::QueryTimer(QueryStats &stats, const char *operation)
+    : stats(stats), operation(operation), rows(0) {
+    timer.start();
+}
+
+QueryTimer::~QueryTimer() {
+    stats.record(operation, timer.nsecsElapsed(), rows, statements);
+}
+
+void QueryTimer::track(const QSqlQuery &query) {
+    if (stats.slowQueryLogEnabled()) {
+        statements.append(QueryStats::Statement{query.lastQuery(), query.boundValues()});
+    }
+}
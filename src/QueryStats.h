@@ -0,0 +1,100 @@
+#ifndef QUERYSTATS_H
+#define QUERYSTATS_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QLatin1String>
+#include <QVariantList>
+#include <QAtomicInteger>
+#include <array>
+
+class QSqlQuery;
+
+// Log-linear latency histogram: 16 linear sub-buckets per power of two, so
+// any recorded value is reported within ~6% using a fixed 8 KiB of counters.
+class LatencyHistogram {
+public:
+    void record(qint64 nanos);
+    void reset();
+    qint64 count() const { return total; }
+    qint64 max() const { return maxValue; }
+    // Upper bound of the bucket holding the given percentile (0-100), in nanoseconds.
+    qint64 percentile(double p) const;
+private:
+    static constexpr int SubBucketBits = 4;
+    static constexpr int SubBuckets = 1 << SubBucketBits;
+    static constexpr int BucketCount = 64 * SubBuckets;
+    static int bucketFor(qint64 nanos);
+    static qint64 upperBound(int bucket);
+    std::array<qint64, BucketCount> counts{};
+    qint64 total = 0;
+    qint64 maxValue = 0;
+};
+
+// Per-operation latency and row counts for Database, plus a size-rotated log
+// of statements slower than a threshold.
+class QueryStats {
+public:
+    struct Summary {
+        QString operation;
+        qint64 calls = 0;
+        qint64 rows = 0;
+        qint64 p50 = 0;
+        qint64 p99 = 0;
+        qint64 max = 0;
+    };
+    struct Statement {
+        QString sql;
+        QVariantList bindings;
+    };
+
+    QueryStats();
+    void record(QLatin1String operation, qint64 nanos, qint64 rows, const QList<Statement> &statements);
+    QList<Summary> summaries() const;
+    QString report() const;
+    void reset();
+
+    // Threshold <= 0 disables the slow-query log. Defaults come from
+    // $TICTACTOE_SLOW_QUERY_MS and $TICTACTOE_SLOW_QUERY_LOG.
+    void setSlowQueryThreshold(qint64 milliseconds);
+    qint64 slowQueryThreshold() const { return slowThresholdNanos.loadRelaxed() / 1000000; }
+    bool slowQueryLogEnabled() const { return slowThresholdNanos.loadRelaxed() > 0; }
+    void setSlowQueryLog(const QString &path, qint64 maxBytes = 1 << 20, int maxFiles = 3);
+
+    static QString bindingShape(const QVariantList &bindings);
+private:
+    struct Operation {
+        LatencyHistogram latency;
+        qint64 rows = 0;
+    };
+    void writeSlowQuery(QLatin1String operation, qint64 nanos, const QList<Statement> &statements);
+    void rotateSlowLog();
+
+    mutable QMutex mutex;
+    QHash<QLatin1String, Operation> operations;
+    QAtomicInteger<qint64> slowThresholdNanos;
+    QString slowLogPath;
+    qint64 slowLogMaxBytes;
+    int slowLogMaxFiles;
+};
+
+// Times one Database operation from construction to destruction. Statements
+// are only captured when the slow-query log is on.
+class QueryTimer {
+public:
+    QueryTimer(QueryStats &stats, const char *operation);
+    ~QueryTimer();
+    void addRows(qint64 count) { rows += count; }
+    void track(const QSqlQuery &query);
+private:
+    QueryStats &stats;
+    QLatin1String operation;
+    QElapsedTimer timer;
+    qint64 rows;
+    QList<QueryStats::Statement> statements;
+};
+
+#endif
@@ -0,0 +1,148 @@
+#include "ReadCache.h"
+#include <limits>
+
+ReadCache::ReadCache(qint64 maxBytes) : entries(maxBytes) {
+}
+
+ReadCache::Entry *ReadCache::lookup(const Key &key, quint64 *generation) {
+    if (generation) {
+        *generation = invalidations;
+    }
+    Entry *entry = entries.object(key);
+    if (entry) {
+        hitCount++;
+    } else {
+        missCount++;
+    }
+    return entry;
+}
+
+void ReadCache::insert(const Key &key, Entry *entry, qint64 cost, quint64 generation) {
+    if (generation != invalidations) {
+        delete entry;
+        return;
+    }
+    // QCache deletes entries costlier than the whole budget straight away.
+    if (entries.insert(key, entry, cost)) {
+        keysByUser[key.userId].insert(key);
+    }
+}
+
+bool ReadCache::history(int userId, int page, QString *history, quint64 *generation) {
+    QMutexLocker locker(&mutex);
+    Entry *entry = lookup({userId, History, page}, generation);
+    if (!entry) {
+        return false;
+    }
+    *history = entry->history;
+    return true;
+}
+
+void ReadCache::putHistory(int userId, int page, const QString &history, quint64 generation) {
+    QMutexLocker locker(&mutex);
+    Entry *entry = new Entry;
+    entry->history = history;
+    insert({userId, History, page}, entry, qint64(sizeof(Entry)) + history.size() * qint64(sizeof(QChar)), generation);
+}
+
+ReadCache::Key ReadCache::recentGamesKey(int userId, int limit, const QDateTime &before, qint64 beforeId) {
+    // Without a valid `before` the id is ignored, so it is left out of the key.
+    if (!before.isValid()) {
+        return {userId, RecentGames, limit, std::numeric_limits<qint64>::min(), 0};
+    }
+    return {userId, RecentGames, limit, before.toMSecsSinceEpoch(), beforeId};
+}
+
+bool ReadCache::recentGames(int userId, int limit, const QDateTime &before, qint64 beforeId,
+                            QList<GameRecord> *games, quint64 *generation) {
+    QMutexLocker locker(&mutex);
+    Entry *entry = lookup(recentGamesKey(userId, limit, before, beforeId), generation);
+    if (!entry) {
+        return false;
+    }
+    *games = entry->games;
+    return true;
+}
+
+void ReadCache::putRecentGames(int userId, int limit, const QDateTime &before, qint64 beforeId,
+                               const QList<GameRecord> &games, quint64 generation) {
+    QMutexLocker locker(&mutex);
+    Entry *entry = new Entry;
+    entry->games = games;
+    qint64 cost = sizeof(Entry);
+    for (const GameRecord &game : games) {
+        cost += sizeof(GameRecord) + (game.board.size() + game.result.size()) * qint64(sizeof(QChar))
+              + game.moves.size() * qint64(sizeof(int));
+    }
+    insert(recentGamesKey(userId, limit, before, beforeId), entry, cost, generation);
+}
+
+bool ReadCache::stats(int userId, UserStats *stats, quint64 *generation) {
+    QMutexLocker locker(&mutex);
+    Entry *entry = lookup({userId, Stats, 0}, generation);
+    if (!entry) {
+        return false;
+    }
+    *stats = entry->stats;
+    return true;
+}
+
+void ReadCache::putStats(int userId, const UserStats &stats, quint64 generation) {
+    QMutexLocker locker(&mutex);
+    Entry *entry = new Entry;
+    entry->stats = stats;
+    insert({userId, Stats, 0}, entry, sizeof(Entry), generation);
+}
+
+void ReadCache::invalidateUser(int userId) {
+    QMutexLocker locker(&mutex);
+    invalidations++;
+    const QSet<Key> keys = keysByUser.take(userId);
+    for (const Key &key : keys) {
+        entries.remove(key);
+    }
+}
+
+void ReadCache::clear() {
+    QMutexLocker locker(&mutex);
+    invalidations++;
+    entries.clear();
+    keysByUser.clear();
+}
+
+void ReadCache::setMaxBytes(qint64 maxBytes) {
+    QMutexLocker locker(&mutex);
+    entries.setMaxCost(maxBytes);
+}
+
+qint64 ReadCache::maxBytes() const {
+    QMutexLocker locker(&mutex);
+    return entries.maxCost();
+}
+
+qint64 ReadCache::bytes() const {
+    QMutexLocker locker(&mutex);
+    return entries.totalCost();
+}
+
+qint64 ReadCache::hits() const {
+    QMutexLocker locker(&mutex);
+    return hitCount;
+}
+
+qint64 ReadCache::misses() const {
+    QMutexLocker locker(&mutex);
+    return missCount;
+}
+
+double ReadCache::hitRate() const {
+    QMutexLocker locker(&mutex);
+    qint64 lookups = hitCount + missCount;
+    return lookups == 0 ? 0.0 : double(hitCount) / lookups;
+}
+
+void ReadCache::resetCounters() {
+    QMutexLocker locker(&mutex);
+    hitCount = 0;
+    missCount = 0;
+}
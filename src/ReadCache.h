@@ -0,0 +1,78 @@
+#ifndef READCACHE_H
+#define READCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QString>
+#include <QDateTime>
+#include "Storage.h"
+
+// LRU cache of per-user reads (formatted history, recent-game pages and
+// stats) held by Database. Entries cost their approximate size in bytes, and writes drop
+// every entry of the affected user.
+class ReadCache {
+public:
+    static constexpr qint64 DefaultBudget = 4 << 20;
+
+    explicit ReadCache(qint64 maxBytes = DefaultBudget);
+    // A miss reports the current generation; a later put with a different
+    // generation is dropped, since an invalidation happened in between and
+    // the value read from the database may already be stale.
+    bool history(int userId, int page, QString *history, quint64 *generation = nullptr);
+    void putHistory(int userId, int page, const QString &history, quint64 generation);
+    // Pages of Storage::getRecentGames, keyed by all of its arguments.
+    bool recentGames(int userId, int limit, const QDateTime &before, qint64 beforeId,
+                     QList<GameRecord> *games, quint64 *generation = nullptr);
+    void putRecentGames(int userId, int limit, const QDateTime &before, qint64 beforeId,
+                        const QList<GameRecord> &games, quint64 generation);
+    bool stats(int userId, UserStats *stats, quint64 *generation = nullptr);
+    void putStats(int userId, const UserStats &stats, quint64 generation);
+    void invalidateUser(int userId);
+    void clear();
+
+    void setMaxBytes(qint64 maxBytes);
+    qint64 maxBytes() const;
+    qint64 bytes() const;
+    qint64 hits() const;
+    qint64 misses() const;
+    // Fraction of lookups served from memory, 0 when nothing was looked up.
+    double hitRate() const;
+    void resetCounters();
+private:
+    enum Kind { History, Stats, RecentGames };
+    struct Key {
+        int userId;
+        Kind kind;
+        int page;
+        // Recent-game cursor: epoch ms (LLONG_MIN for the first page) and id.
+        qint64 before = 0;
+        qint64 beforeId = 0;
+        bool operator==(const Key &other) const {
+            return userId == other.userId && kind == other.kind && page == other.page
+                && before == other.before && beforeId == other.beforeId;
+        }
+        friend size_t qHash(const Key &key, size_t seed) {
+            return qHashMulti(seed, key.userId, int(key.kind), key.page, key.before, key.beforeId);
+        }
+    };
+    struct Entry {
+        QString history;
+        UserStats stats;
+        QList<GameRecord> games;
+    };
+    static Key recentGamesKey(int userId, int limit, const QDateTime &before, qint64 beforeId);
+    Entry *lookup(const Key &key, quint64 *generation);
+    void insert(const Key &key, Entry *entry, qint64 cost, quint64 generation);
+
+    mutable QMutex mutex;
+    QCache<Key, Entry> entries;
+    // Keys may outlive evicted entries; they are dropped on the next invalidation.
+    QHash<int, QSet<Key>> keysByUser;
+    qint64 hitCount = 0;
+    qint64 missCount = 0;
+    quint64 invalidations = 0;
+};
+
+#endif
@@ -5,8 +5,10 @@
 #include <QMessageBox>
 #include <QRegularExpression>
 
-RegisterWindow::RegisterWindow(Database *db, QWidget *parent)
+RegisterWindow::RegisterWindow(Storage *db, QWidget *parent)
     : QMainWindow(parent), db(db) {
+    auth = new AuthService(db, this);
+    connect(auth, &AuthService::registrationFinished, this, &RegisterWindow::finishRegister);
     setMinimumSize(350, 450);
     setupUI();
 
@@ -83,7 +85,7 @@ void RegisterWindow::setupUI() {
     formLayout->addWidget(confirmPasswordEdit);
 
     QHBoxLayout *buttonLayout = new QHBoxLayout();
-    QPushButton *registerButton = new QPushButton("REGISTER", this);
+    registerButton = new QPushButton("REGISTER", this);
     QPushButton *cancelButton = new QPushButton("CANCEL", this);
     buttonLayout->addWidget(registerButton);
     buttonLayout->addWidget(cancelButton);
@@ -134,7 +136,14 @@ void RegisterWindow::attemptRegister() {
         return;
     }
 
-    if (db->registerUser(username, password)) {
+    registerButton->setEnabled(false);
+    auth->registerUser(username, password);
+}
+
+void RegisterWindow::finishRegister(const QString &username, bool registered) {
+    Q_UNUSED(username);
+    registerButton->setEnabled(true);
+    if (registered) {
         QMessageBox::information(this, "SUCCESS", "REGISTERED SUCCESSFULLY! PLEASE LOGIN.");
         emit registrationSuccessful();
         this->close();
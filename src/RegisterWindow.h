@@ -4,16 +4,19 @@
 #include <QMainWindow>
 #include <QLineEdit>
 #include <QLabel> // Ensure QLabel is included here
-#include "Database.h"
+#include <QPushButton>
+#include "Storage.h"
+#include "AuthService.h"
 
 class RegisterWindow : public QMainWindow {
     Q_OBJECT
 public:
-    RegisterWindow(Database *db, QWidget *parent = nullptr);
+    RegisterWindow(Storage *db, QWidget *parent = nullptr);
 signals:
     void registrationSuccessful();
 private slots:
     void attemptRegister();
+    void finishRegister(const QString &username, bool registered);
     void cancelRegistration();
     void updatePasswordStrength();
 private:
@@ -22,7 +25,9 @@ private:
     QLineEdit *passwordEdit;
     QLineEdit *confirmPasswordEdit;
     QLabel *passwordStrengthLabel; // Add this member variable
-    Database *db;
+    QPushButton *registerButton;
+    Storage *db;
+    AuthService *auth;
 };
 
 #endif
@@ -0,0 +1,36 @@
+#include "ReplayTimeline.h"
+#include <QtGlobal>
+
+ReplayTimeline::ReplayTimeline(const QVector<int> &moveList, int boardSize, char firstSymbol)
+    : size(qMax(1, boardSize)) {
+    const char secondSymbol = firstSymbol == 'X' ? 'O' : 'X';
+    QVector<char> board(size * size, ' ');
+    positions.reserve(moveList.size() + 1);
+    positions.append(board);
+    for (int cell : moveList) {
+        if (cell < 0 || cell >= board.size() || board[cell] != ' ') {
+            break;
+        }
+        board[cell] = moves.size() % 2 == 0 ? firstSymbol : secondSymbol;
+        moves.append(cell);
+        positions.append(board);
+    }
+}
+
+ReplayTimeline ReplayTimeline::finalPosition(const QString &board, int boardSize) {
+    ReplayTimeline timeline({}, boardSize);
+    QVector<char> &marks = timeline.positions[0];
+    for (int cell = 0; cell < marks.size() && cell < board.size(); ++cell) {
+        const char mark = board[cell].toLatin1();
+        marks[cell] = mark == 'X' || mark == 'O' ? mark : ' ';
+    }
+    return timeline;
+}
+
+const QVector<char> &ReplayTimeline::positionAt(int step) const {
+    return positions[qBound(0, step, length())];
+}
+
+int ReplayTimeline::moveAt(int step) const {
+    return step >= 1 && step <= length() ? moves[step - 1] : -1;
+}
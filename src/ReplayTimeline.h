@@ -0,0 +1,30 @@
+#ifndef REPLAYTIMELINE_H
+#define REPLAYTIMELINE_H
+
+#include <QVector>
+#include <QString>
+
+// Every position of a recorded game, built once from its move list so any
+// step can be shown without replaying the moves before it. Moves are cell
+// indexes (row * boardSize + col); the sides alternate starting with
+// `firstSymbol`. A move onto an occupied or missing cell ends the timeline.
+class ReplayTimeline {
+public:
+    ReplayTimeline(const QVector<int> &moveList = {}, int boardSize = 3, char firstSymbol = 'X');
+    // A single step showing `board` (row-major, ' ' for empty), for games
+    // stored without their moves.
+    static ReplayTimeline finalPosition(const QString &board, int boardSize = 3);
+    int boardSize() const { return size; }
+    // Number of moves; valid steps are 0 (empty board) to length().
+    int length() const { return static_cast<int>(positions.size()) - 1; }
+    // Row-major marks after `step` moves, ' ' for empty. Steps are clamped.
+    const QVector<char> &positionAt(int step) const;
+    // Cell played to reach `step`, -1 for step 0.
+    int moveAt(int step) const;
+private:
+    int size;
+    QVector<int> moves;
+    QVector<QVector<char>> positions;
+};
+
+#endif
@@ -1,88 +1,83 @@
 #include "ReplayWindow.h"
-#include <QGridLayout>
 #include <QVBoxLayout>
+#include <QHBoxLayout>
 #include <QLabel>
 
-ReplayWindow::ReplayWindow(const QString &moves, const QString &result, char playerSymbol, QWidget *parent)
-    : QMainWindow(parent), replayIndex(0), playerSymbol(playerSymbol) {
-    // Initialize replay board
-    for (int i = 0; i < 3; ++i)
-        for (int j = 0; j < 3; ++j)
-            replayBoard[i][j] = ' ';
-
-    replayMoves = moves.split(";", Qt::SkipEmptyParts);
-    replayTimer = new QTimer(this);
-    connect(replayTimer, &QTimer::timeout, this, &ReplayWindow::processReplayMove);
-    setupUI();
-    resultLabel->setText(QString("RESULT: %1").arg(result));
-    replayTimer->start(1000); // Show each move every 1 second
+// Games saved before moves were recorded can only show their final board.
+static ReplayTimeline timelineFor(const GameRecord &game) {
+    if (game.moves.isEmpty()) {
+        return ReplayTimeline::finalPosition(game.board);
+    }
+    return ReplayTimeline(game.moves, 3, game.playerSymbol);
+}
+
+ReplayWindow::ReplayWindow(const GameRecord &game, QWidget *parent)
+    : ReplayWindow(timelineFor(game), game.result, parent) {
+}
+
+ReplayWindow::ReplayWindow(const ReplayTimeline &timeline, const QString &result, QWidget *parent)
+    : QMainWindow(parent), timeline(timeline), step(0), playbackSpeed(1.0) {
+    timer = new QTimer(this);
+    timer->setInterval(BaseIntervalMs);
+    connect(timer, &QTimer::timeout, this, &ReplayWindow::advance);
+    setupUI(result);
+    boardView->setMarks(timeline.positionAt(step));
+    updateControls();
 }
 
-void ReplayWindow::setupUI() {
+void ReplayWindow::setupUI(const QString &result) {
     setWindowTitle("GAME REPLAY");
     QWidget *centralWidget = new QWidget(this);
     setCentralWidget(centralWidget);
     QVBoxLayout *mainLayout = new QVBoxLayout(centralWidget);
 
-    resultLabel = new QLabel("", this);
+    resultLabel = new QLabel(QString("RESULT: %1").arg(result), this);
     resultLabel->setStyleSheet(
         "font-size: 16px;"
         "color: #bb00ff;"
-        "text-shadow: 0 0 8px #bb00ff;"
         "font-family: 'Orbitron', 'Arial', sans-serif;"
         );
     mainLayout->addWidget(resultLabel, 0, Qt::AlignCenter);
 
-    QGridLayout *boardLayout = new QGridLayout();
-    boardLayout->setSpacing(0);
-    boardLayout->setContentsMargins(0, 0, 0, 0);
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            cells[i][j] = new QPushButton("", this);
-            cells[i][j]->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
-            cells[i][j]->setEnabled(false); // Disable interaction
-            QString borderStyle;
-            if (i == 0 && j == 0) {
-                borderStyle = "border-bottom: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            } else if (i == 0 && j == 1) {
-                borderStyle = "border-bottom: 1px solid #bb00ff; border-left: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            } else if (i == 0 && j == 2) {
-                borderStyle = "border-bottom: 1px solid #bb00ff; border-left: 1px solid #bb00ff;";
-            } else if (i == 1 && j == 0) {
-                borderStyle = "border-top: 1px solid #bb00ff; border-bottom: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            } else if (i == 1 && j == 1) {
-                borderStyle = "border: 1px solid #bb00ff;";
-            } else if (i == 1 && j == 2) {
-                borderStyle = "border-top: 1px solid #bb00ff; border-bottom: 1px solid #bb00ff; border-left: 1px solid #bb00ff;";
-            } else if (i == 2 && j == 0) {
-                borderStyle = "border-top: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            } else if (i == 2 && j == 1) {
-                borderStyle = "border-top: 1px solid #bb00ff; border-left: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            } else if (i == 2 && j == 2) {
-                borderStyle = "border-top: 1px solid #bb00ff; border-left: 1px solid #bb00ff;";
-            }
-            cells[i][j]->setStyleSheet(
-                QString(
-                    "QPushButton {"
-                    "    background-color: rgba(20, 20, 40, 0.7);"
-                    "    %1"
-                    "    border-radius: 0px;"
-                    "    font-size: 40px;"
-                    "    font-family: 'Orbitron', 'Arial', sans-serif;"
-                    "    color: transparent;"
-                    "    text-align: center;"
-                    "    line-height: 100px;" // Ensure vertical centering
-                    "    margin: 0px;"
-                    "    padding: 0px;"
-                    "    min-width: 100px;"
-                    "    min-height: 100px;"
-                    "}"
-                    ).arg(borderStyle)
-                );
-            boardLayout->addWidget(cells[i][j], i, j);
-        }
-    }
-    mainLayout->addLayout(boardLayout);
+    boardView = new BoardView(timeline.boardSize(), false, this);
+    mainLayout->addWidget(boardView, 1);
+
+    stepLabel = new QLabel(this);
+    stepLabel->setObjectName("stepLabel");
+    mainLayout->addWidget(stepLabel, 0, Qt::AlignCenter);
+
+    slider = new QSlider(Qt::Horizontal, this);
+    slider->setObjectName("replaySlider");
+    slider->setRange(0, timeline.length());
+    slider->setPageStep(qMax(1, timeline.length() / 10));
+    // Dragging seeks continuously; each seek is a table lookup.
+    connect(slider, &QSlider::valueChanged, this, &ReplayWindow::seek);
+    mainLayout->addWidget(slider);
+
+    QHBoxLayout *controls = new QHBoxLayout();
+    backButton = new QPushButton("<", this);
+    backButton->setObjectName("stepBackButton");
+    playButton = new QPushButton("PLAY", this);
+    playButton->setObjectName("playButton");
+    forwardButton = new QPushButton(">", this);
+    forwardButton->setObjectName("stepForwardButton");
+    speedBox = new QDoubleSpinBox(this);
+    speedBox->setObjectName("speedBox");
+    speedBox->setRange(MinSpeed, MaxSpeed);
+    speedBox->setDecimals(1);
+    speedBox->setStepType(QAbstractSpinBox::AdaptiveDecimalStepType);
+    speedBox->setSuffix("x");
+    speedBox->setValue(playbackSpeed);
+    controls->addWidget(backButton);
+    controls->addWidget(playButton);
+    controls->addWidget(forwardButton);
+    controls->addWidget(speedBox);
+    mainLayout->addLayout(controls);
+
+    connect(backButton, &QPushButton::clicked, this, &ReplayWindow::stepBack);
+    connect(playButton, &QPushButton::clicked, this, &ReplayWindow::togglePlay);
+    connect(forwardButton, &QPushButton::clicked, this, &ReplayWindow::stepForward);
+    connect(speedBox, &QDoubleSpinBox::valueChanged, this, &ReplayWindow::setSpeed);
 
     setStyleSheet(
         "QMainWindow {"
@@ -94,113 +89,85 @@ void ReplayWindow::setupUI() {
         "    color: #e0e0ff;"
         "    font-family: 'Orbitron', 'Arial', sans-serif;"
         "}"
+        "QPushButton {"
+        "    background-color: rgba(30, 30, 60, 0.8);"
+        "    color: #e0e0ff;"
+        "    border: 2px solid #bb00ff;"
+        "    border-radius: 8px;"
+        "    padding: 8px;"
+        "    font-size: 16px;"
+        "    font-family: 'Orbitron', 'Arial', sans-serif;"
+        "}"
         );
 }
 
-void ReplayWindow::processReplayMove() {
-    if (replayIndex >= replayMoves.size()) {
-        replayTimer->stop();
+void ReplayWindow::play() {
+    if (timeline.length() == 0) {
         return;
     }
+    // Playing from the end starts over.
+    if (step >= timeline.length()) {
+        seek(0);
+    }
+    timer->start();
+    updateControls();
+}
 
-    QStringList move = replayMoves[replayIndex].split(",");
-    if (move.size() != 2) {
-        replayTimer->stop();
+void ReplayWindow::pause() {
+    timer->stop();
+    updateControls();
+}
+
+void ReplayWindow::togglePlay() {
+    if (isPlaying()) {
+        pause();
+    } else {
+        play();
+    }
+}
+
+void ReplayWindow::stepForward() {
+    pause();
+    seek(step + 1);
+}
+
+void ReplayWindow::stepBack() {
+    pause();
+    seek(step - 1);
+}
+
+void ReplayWindow::advance() {
+    seek(step + 1);
+    if (step >= timeline.length()) {
+        pause();
+    }
+}
+
+void ReplayWindow::seek(int target) {
+    target = qBound(0, target, timeline.length());
+    if (target == step) {
         return;
     }
+    step = target;
+    // Only cells that differ from the shown position are repainted.
+    boardView->setMarks(timeline.positionAt(step));
+    updateControls();
+}
 
-    int row = move[0].toInt();
-    int col = move[1].toInt();
-    char symbol = (replayIndex % 2 == 0) ? playerSymbol : (playerSymbol == 'X' ? 'O' : 'X');
-    replayBoard[row][col] = symbol;
-
-    // Update UI
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            QString text = QString(replayBoard[i][j]);
-            cells[i][j]->setText(text);
-            QString borderStyle;
-            if (i == 0 && j == 0) {
-                borderStyle = "border-bottom: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            } else if (i == 0 && j == 1) {
-                borderStyle = "border-bottom: 1px solid #bb00ff; border-left: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            } else if (i == 0 && j == 2) {
-                borderStyle = "border-bottom: 1px solid #bb00ff; border-left: 1px solid #bb00ff;";
-            } else if (i == 1 && j == 0) {
-                borderStyle = "border-top: 1px solid #bb00ff; border-bottom: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            } else if (i == 1 && j == 1) {
-                borderStyle = "border: 1px solid #bb00ff;";
-            } else if (i == 1 && j == 2) {
-                borderStyle = "border-top: 1px solid #bb00ff; border-bottom: 1px solid #bb00ff; border-left: 1px solid #bb00ff;";
-            } else if (i == 2 && j == 0) {
-                borderStyle = "border-top: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            } else if (i == 2 && j == 1) {
-                borderStyle = "border-top: 1px solid #bb00ff; border-left: 1px solid #bb00ff; border-right: 1px solid #bb00ff;";
-            } else if (i == 2 && j == 2) {
-                borderStyle = "border-top: 1px solid #bb00ff; border-left: 1px solid #bb00ff;";
-            }
-            if (text == "X") {
-                cells[i][j]->setStyleSheet(
-                    QString(
-                        "QPushButton {"
-                        "    background-color: rgba(20, 20, 40, 0.7);"
-                        "    %1"
-                        "    border-radius: 0px;"
-                        "    font-size: 40px;"
-                        "    font-family: 'Orbitron', 'Arial', sans-serif;"
-                        "    color: #00eaff;"
-                        "    text-shadow: 0 0 10px #00eaff, 0 0 20px #00eaff;"
-                        "    text-align: center;"
-                        "    line-height: 100px;" // Ensure vertical centering
-                        "    margin: 0px;"
-                        "    padding: 0px;"
-                        "    min-width: 100px;"
-                        "    min-height: 100px;"
-                        "}"
-                        ).arg(borderStyle)
-                    );
-            } else if (text == "O") {
-                cells[i][j]->setStyleSheet(
-                    QString(
-                        "QPushButton {"
-                        "    background-color: rgba(20, 20, 40, 0.7);"
-                        "    %1"
-                        "    border-radius: 0px;"
-                        "    font-size: 40px;"
-                        "    font-family: 'Orbitron', 'Arial', sans-serif;"
-                        "    color: #ff00cc;"
-                        "    text-shadow: 0 0 10px #ff00cc, 0 0 20px #ff00cc;"
-                        "    text-align: center;"
-                        "    line-height: 100px;" // Ensure vertical centering
-                        "    margin: 0px;"
-                        "    padding: 0px;"
-                        "    min-width: 100px;"
-                        "    min-height: 100px;"
-                        "}"
-                        ).arg(borderStyle)
-                    );
-            } else {
-                cells[i][j]->setStyleSheet(
-                    QString(
-                        "QPushButton {"
-                        "    background-color: rgba(20, 20, 40, 0.7);"
-                        "    %1"
-                        "    border-radius: 0px;"
-                        "    font-size: 40px;"
-                        "    font-family: 'Orbitron', 'Arial', sans-serif;"
-                        "    color: transparent;"
-                        "    text-align: center;"
-                        "    line-height: 100px;" // Ensure vertical centering
-                        "    margin: 0px;"
-                        "    padding: 0px;"
-                        "    min-width: 100px;"
-                        "    min-height: 100px;"
-                        "}"
-                        ).arg(borderStyle)
-                    );
-            }
-        }
+void ReplayWindow::setSpeed(double value) {
+    playbackSpeed = qBound(MinSpeed, value, MaxSpeed);
+    timer->setInterval(qMax(1, qRound(BaseIntervalMs / playbackSpeed)));
+    if (speedBox->value() != playbackSpeed) {
+        speedBox->setValue(playbackSpeed);
     }
+}
 
-    replayIndex++;
+void ReplayWindow::updateControls() {
+    stepLabel->setText(QString("MOVE %1 / %2").arg(step).arg(timeline.length()));
+    // The slider calls back into seek(), which returns early for the same step.
+    slider->setValue(step);
+    playButton->setText(isPlaying() ? "PAUSE" : "PLAY");
+    playButton->setEnabled(timeline.length() > 0);
+    backButton->setEnabled(step > 0);
+    forwardButton->setEnabled(step < timeline.length());
 }
@@ -2,26 +2,58 @@
 #define REPLAYWINDOW_H
 
 #include <QMainWindow>
-#include <QPushButton>
 #include <QLabel>
+#include <QPushButton>
+#include <QSlider>
+#include <QDoubleSpinBox>
 #include <QTimer>
-#include "Game.h"
+#include "Storage.h"
+#include "BoardView.h"
+#include "ReplayTimeline.h"
 
+// Plays back a stored game with play/pause, single steps, a scrub slider and
+// a playback speed from 0.1x to 50x. Every seek shows a precomputed
+// position from the timeline, so jumping anywhere costs the same.
 class ReplayWindow : public QMainWindow {
     Q_OBJECT
 public:
-    ReplayWindow(const QString &moves, const QString &result, char playerSymbol, QWidget *parent = nullptr);
+    static constexpr double MinSpeed = 0.1;
+    static constexpr double MaxSpeed = 50.0;
+    // One move per second at 1x.
+    static constexpr int BaseIntervalMs = 1000;
+
+    explicit ReplayWindow(const GameRecord &game, QWidget *parent = nullptr);
+    ReplayWindow(const ReplayTimeline &timeline, const QString &result, QWidget *parent = nullptr);
+    int currentStep() const { return step; }
+    const ReplayTimeline &replayTimeline() const { return timeline; }
+    bool isPlaying() const { return timer->isActive(); }
+    double speed() const { return playbackSpeed; }
+public slots:
+    void play();
+    void pause();
+    void togglePlay();
+    void stepForward();
+    void stepBack();
+    void seek(int target);
+    void setSpeed(double value);
 private slots:
-    void processReplayMove();
+    void advance();
 private:
-    void setupUI();
-    QPushButton *cells[3][3];
-    char replayBoard[3][3];
-    QStringList replayMoves;
-    int replayIndex;
+    void setupUI(const QString &result);
+    void updateControls();
+
+    ReplayTimeline timeline;
+    int step;
+    double playbackSpeed;
+    BoardView *boardView;
     QLabel *resultLabel;
-    QTimer *replayTimer;
-    char playerSymbol;
+    QLabel *stepLabel;
+    QPushButton *playButton;
+    QPushButton *backButton;
+    QPushButton *forwardButton;
+    QSlider *slider;
+    QDoubleSpinBox *speedBox;
+    QTimer *timer;
 };
 
-#endif
\ No newline at end of file
+#endif
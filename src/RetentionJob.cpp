@@ -0,0 +1,40 @@
+#include "RetentionJob.h"
+#include <QtConcurrent/QtConcurrent>
+#include <QDebug>
+
+RetentionJob::RetentionJob(Database *db, int maxAgeDays, QObject *parent)
+    : QObject(parent), db(db), maxAgeDays(maxAgeDays) {
+    connect(&timer, &QTimer::timeout, this, &RetentionJob::runNow);
+    connect(&watcher, &QFutureWatcher<RetentionResult>::finished, this, [this]() {
+        RetentionResult result = watcher.result();
+        if (!result.ok) {
+            qDebug() << "Retention error: run did not complete";
+        }
+        emit finished(result.archived, result.reclaimedPages);
+    });
+}
+
+RetentionJob::~RetentionJob() {
+    watcher.waitForFinished();
+}
+
+RetentionJob *RetentionJob::fromEnvironment(Database *db, QObject *parent) {
+    int days = qEnvironmentVariableIntValue("TICTACTOE_RETENTION_DAYS");
+    return days > 0 ? new RetentionJob(db, days, parent) : nullptr;
+}
+
+void RetentionJob::start(int intervalMs) {
+    timer.start(intervalMs);
+    runNow();
+}
+
+void RetentionJob::runNow() {
+    if (watcher.isRunning()) {
+        return;
+    }
+    Database *database = db;
+    QDateTime cutoff = QDateTime::currentDateTimeUtc().addDays(-maxAgeDays);
+    watcher.setFuture(QtConcurrent::run([database, cutoff]() {
+        return database->applyRetention(cutoff);
+    }));
+}
@@ -0,0 +1,31 @@
+#ifndef RETENTIONJOB_H
+#define RETENTIONJOB_H
+
+#include <QObject>
+#include <QTimer>
+#include <QFutureWatcher>
+#include "Database.h"
+
+// Periodically runs Database::applyRetention on a worker thread. Games older
+// than maxAgeDays are rolled up and deleted; a run is skipped while the
+// previous one is still going.
+class RetentionJob : public QObject {
+    Q_OBJECT
+public:
+    RetentionJob(Database *db, int maxAgeDays, QObject *parent = nullptr);
+    ~RetentionJob() override;
+    // Configured by $TICTACTOE_RETENTION_DAYS; nullptr when unset or zero.
+    static RetentionJob *fromEnvironment(Database *db, QObject *parent = nullptr);
+    void start(int intervalMs = 6 * 60 * 60 * 1000);
+    void runNow();
+    bool isRunning() const { return watcher.isRunning(); }
+signals:
+    void finished(qint64 archived, qint64 reclaimedPages);
+private:
+    Database *db;
+    int maxAgeDays;
+    QTimer timer;
+    QFutureWatcher<RetentionResult> watcher;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#include "SnapshotJob.h"
+#include <QtConcurrent/QtConcurrent>
+
+SnapshotJob::SnapshotJob(Database *db, const QString &path, QObject *parent)
+    : QObject(parent), db(db), enabled(false) {
+    connect(&timer, &QTimer::timeout, this, &SnapshotJob::refreshNow);
+    connect(&watcher, &QFutureWatcher<bool>::finished, this, [this]() {
+        bool ok = watcher.result();
+        if (!enabled && !ok) {
+            timer.stop();
+        }
+        enabled = enabled || ok;
+        emit refreshed(ok);
+    });
+    // The first copy is a full backup, so it is taken off the calling thread
+    // like every later refresh.
+    watcher.setFuture(QtConcurrent::run([db, path]() {
+        return db->enableSnapshot(path);
+    }));
+}
+
+SnapshotJob::~SnapshotJob() {
+    watcher.waitForFinished();
+}
+
+SnapshotJob *SnapshotJob::fromEnvironment(Database *db, QObject *parent) {
+    const QString path = qEnvironmentVariable("TICTACTOE_SNAPSHOT_PATH");
+    if (path.isEmpty()) {
+        return nullptr;
+    }
+    return new SnapshotJob(db, path, parent);
+}
+
+void SnapshotJob::start(int intervalMs) {
+    if (intervalMs <= 0) {
+        bool ok = false;
+        intervalMs = qEnvironmentVariableIntValue("TICTACTOE_SNAPSHOT_REFRESH_MS", &ok);
+        if (!ok || intervalMs <= 0) {
+            intervalMs = 60 * 1000;
+        }
+    }
+    timer.start(intervalMs);
+}
+
+void SnapshotJob::refreshNow() {
+    if (!enabled || watcher.isRunning()) {
+        return;
+    }
+    Database *database = db;
+    watcher.setFuture(QtConcurrent::run([database]() {
+        return database->refreshSnapshot();
+    }));
+}
@@ -0,0 +1,33 @@
+#ifndef SNAPSHOTJOB_H
+#define SNAPSHOTJOB_H
+
+#include <QObject>
+#include <QTimer>
+#include <QFutureWatcher>
+#include "Database.h"
+
+// Keeps a Database's read-only snapshot fresh by calling refreshSnapshot on a
+// worker thread every interval. A refresh is skipped while one is running.
+class SnapshotJob : public QObject {
+    Q_OBJECT
+public:
+    SnapshotJob(Database *db, const QString &path, QObject *parent = nullptr);
+    ~SnapshotJob() override;
+    // The first snapshot is taken on a worker thread; refreshed() reports it
+    // and the job stays idle if it failed.
+    // Configured by $TICTACTOE_SNAPSHOT_PATH; nullptr when unset.
+    static SnapshotJob *fromEnvironment(Database *db, QObject *parent = nullptr);
+    bool isEnabled() const { return enabled; }
+    // Interval from $TICTACTOE_SNAPSHOT_REFRESH_MS when zero, default one minute.
+    void start(int intervalMs = 0);
+    void refreshNow();
+signals:
+    void refreshed(bool ok);
+private:
+    Database *db;
+    bool enabled;
+    QTimer timer;
+    QFutureWatcher<bool> watcher;
+};
+
+#endif
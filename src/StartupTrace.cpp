@@ -0,0 +1,67 @@
+#include "StartupTrace.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QMutex>
+#include <QWidget>
+
+namespace {
+
+QElapsedTimer startClock() {
+    QElapsedTimer clock;
+    clock.start();
+    return clock;
+}
+
+const QElapsedTimer processClock = startClock();
+QMutex phasesMutex;
+QList<QPair<QString, qint64>> reached;
+
+class FirstPaintFilter : public QObject {
+public:
+    FirstPaintFilter(const QString &phase, QObject *parent) : QObject(parent), phase(phase) {}
+    bool eventFilter(QObject *watched, QEvent *event) override {
+        if (event->type() == QEvent::Paint) {
+            StartupTrace::mark(phase);
+            watched->removeEventFilter(this);
+            deleteLater();
+        }
+        return false;
+    }
+private:
+    QString phase;
+};
+
+}
+
+bool StartupTrace::enabled() {
+    static const bool on = qEnvironmentVariableIsSet("TICTACTOE_STARTUP_TRACE");
+    return on;
+}
+
+void StartupTrace::mark(const QString &phase) {
+    const qint64 ms = processClock.elapsed();
+    QMutexLocker locker(&phasesMutex);
+    for (const auto &entry : reached) {
+        if (entry.first == phase) {
+            return;
+        }
+    }
+    reached.append(qMakePair(phase, ms));
+    if (enabled()) {
+        qDebug().noquote() << "Startup:" << phase << "at" << ms << "ms";
+    }
+}
+
+void StartupTrace::markFirstPaint(QWidget *widget, const QString &phase) {
+    widget->installEventFilter(new FirstPaintFilter(phase, widget));
+}
+
+qint64 StartupTrace::elapsedMs() {
+    return processClock.elapsed();
+}
+
+QList<QPair<QString, qint64>> StartupTrace::phases() {
+    QMutexLocker locker(&phasesMutex);
+    return reached;
+}
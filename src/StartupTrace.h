@@ -0,0 +1,24 @@
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+
+class QWidget;
+
+// Milestones from process start to a usable window. Times are measured from
+// static initialization, just before main() runs, and each phase is printed
+// as it is reached when $TICTACTOE_STARTUP_TRACE is set.
+class StartupTrace {
+public:
+    static bool enabled();
+    // Records `phase` the first time it is reached; repeats are ignored.
+    static void mark(const QString &phase);
+    // Marks `phase` when `widget` receives its first paint event.
+    static void markFirstPaint(QWidget *widget, const QString &phase);
+    static qint64 elapsedMs();
+    static QList<QPair<QString, qint64>> phases();
+};
+
+#endif
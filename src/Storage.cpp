@@ -0,0 +1,96 @@
+#include "Storage.h"
+#include "PasswordHasher.h"
+#include "BoardCodec.h"
+#include <algorithm>
+
+QList<GameRecord> Storage::getGamesThisWeek(int userId) {
+    QDate today = QDate::currentDate();
+    QDateTime weekStart(today.addDays(1 - today.dayOfWeek()), QTime(0, 0));
+    return getGamesBetween(userId, weekStart, QDateTime::currentDateTime().addMSecs(1));
+}
+
+Storage::Outcome Storage::outcomeFor(const QString &result, char playerSymbol) {
+    if (result == "Tie" || result == "Draw") return Tie;
+    if (result == "Win") return Win;
+    if (result == "Loss") return Loss;
+    return result == QString(playerSymbol) ? Win : Loss;
+}
+
+char Storage::winnerFor(const QString &result, char playerSymbol) {
+    Outcome outcome = outcomeFor(result, playerSymbol);
+    if (outcome == Tie) return ' ';
+    char opponent = playerSymbol == 'X' ? 'O' : 'X';
+    return outcome == Win ? playerSymbol : opponent;
+}
+
+QVector<int> Storage::positionsOf(const char board[3][3], const QVector<int> &moves) {
+    QVector<int> positions;
+    char replay[3][3] = {{' ', ' ', ' '}, {' ', ' ', ' '}, {' ', ' ', ' '}};
+    for (int cell : moves) {
+        if (cell < 0 || cell > 8 || replay[cell / 3][cell % 3] != ' ' || board[cell / 3][cell % 3] == ' ') {
+            positions.clear();
+            break;
+        }
+        // Cells are never overwritten, so the final board says who played each move.
+        replay[cell / 3][cell % 3] = board[cell / 3][cell % 3];
+        positions.append(BoardCodec::canonical(BoardCodec::encode(replay)));
+    }
+    if (positions.isEmpty()) {
+        positions.append(BoardCodec::canonical(BoardCodec::encode(board)));
+    }
+    return positions;
+}
+
+void Storage::countPositions(QHash<int, PositionStats> &counts, const char board[3][3],
+                             const QString &result, char playerSymbol, const QVector<int> &moves) {
+    char winner = winnerFor(result, playerSymbol);
+    for (int position : positionsOf(board, moves)) {
+        PositionStats &p = counts[position];
+        p.occurrences++;
+        if (winner == 'X') p.xWins++;
+        else if (winner == 'O') p.oWins++;
+        else p.ties++;
+    }
+}
+
+void Storage::addOutcome(UserStats &s, bool vsAI, Outcome outcome) {
+    s.totalGames++;
+    (vsAI ? s.aiGames : s.pvpGames)++;
+    if (outcome == Win) {
+        s.wins++;
+        (vsAI ? s.aiWins : s.pvpWins)++;
+        s.currentStreak++;
+        s.bestStreak = std::max(s.bestStreak, s.currentStreak);
+    } else {
+        if (outcome == Loss) {
+            s.losses++;
+            (vsAI ? s.aiLosses : s.pvpLosses)++;
+        } else {
+            s.ties++;
+            (vsAI ? s.aiTies : s.pvpTies)++;
+        }
+        s.currentStreak = 0;
+    }
+}
+
+QString Storage::hashPassword(const QString &password) {
+    return PasswordHasher::hash(password);
+}
+
+bool Storage::verifyPassword(const QString &password, const QString &stored) {
+    return PasswordHasher::verify(password, stored);
+}
+
+bool Storage::isValidUsername(const QString &username) {
+    QString trimmedUsername = username.trimmed();
+    return !trimmedUsername.isEmpty();
+}
+
+QString Storage::formatHistory(const QList<GameRecord> &games) {
+    QString history;
+    for (const GameRecord &game : games) {
+        history += QString("Game at %1: Board: %2, Result: %3\n")
+                       .arg(game.playedAt.toLocalTime().toString(), game.board, game.result);
+    }
+    return history.isEmpty() ? "No games played." : history;
+}
@@ -0,0 +1,93 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QDateTime>
+
+struct UserStats {
+    int totalGames = 0;
+    int wins = 0;
+    int losses = 0;
+    int ties = 0;
+    int currentStreak = 0;
+    int bestStreak = 0;
+    int aiGames = 0;
+    int aiWins = 0;
+    int aiLosses = 0;
+    int aiTies = 0;
+    int pvpGames = 0;
+    int pvpWins = 0;
+    int pvpLosses = 0;
+    int pvpTies = 0;
+};
+
+struct GameRecord {
+    qint64 id = -1;
+    int userId = -1;
+    QString board;
+    QString result;
+    QDateTime playedAt;
+    bool vsAI = false;
+    char playerSymbol = 'X';
+    int outcome = 0;
+    QVector<int> moves;
+};
+
+// How often a position (up to symmetry) occurred in saved games and how those games ended.
+struct PositionStats {
+    qint64 occurrences = 0;
+    qint64 xWins = 0;
+    qint64 oWins = 0;
+    qint64 ties = 0;
+};
+
+// Operations the game and its windows need from a store of users and games.
+// Database is the SQLite implementation; MemoryStorage keeps everything in
+// process maps.
+class Storage {
+public:
+    enum Outcome { Win = 0, Loss = 1, Tie = 2 };
+
+    virtual ~Storage() = default;
+    virtual int authenticate(const QString &username, const QString &password) = 0;
+    virtual bool registerUser(const QString &username, const QString &password) = 0;
+    // `moves` lists the cells played in order (row * 3 + col); it feeds replays
+    // and per-position statistics.
+    virtual bool saveGame(int userId, char board[3][3], const QString &result, bool vsAI = false,
+                          char playerSymbol = 'X', const QVector<int> &moves = {}) = 0;
+    virtual QString getGameHistory(int userId) = 0;
+    virtual UserStats getUserStats(int userId) = 0;
+    // Half-open range [from, to).
+    virtual QList<GameRecord> getGamesBetween(int userId, const QDateTime &from, const QDateTime &to) = 0;
+    QList<GameRecord> getGamesThisWeek(int userId);
+    // One page of a user's games, newest first: at most `limit` games played
+    // before (`before`, `beforeId`). Pass the last game of a page to get the
+    // next one; an invalid `before` starts from the newest game.
+    virtual QList<GameRecord> getRecentGames(int userId, int limit, const QDateTime &before = QDateTime(),
+                                             qint64 beforeId = -1) = 0;
+    virtual PositionStats getPositionStats(const char board[3][3]) = 0;
+
+    static Outcome outcomeFor(const QString &result, char playerSymbol);
+    // 'X', 'O', or ' ' for a tie.
+    static char winnerFor(const QString &result, char playerSymbol);
+protected:
+    // Canonical codes of every position the game passed through, or just the
+    // final board when the move list is missing or inconsistent with it.
+    static QVector<int> positionsOf(const char board[3][3], const QVector<int> &moves);
+    // Adds one finished game to per-position counts.
+    static void countPositions(QHash<int, PositionStats> &counts, const char board[3][3],
+                               const QString &result, char playerSymbol, const QVector<int> &moves);
+    // Counts one finished game into `stats`, streaks included.
+    static void addOutcome(UserStats &stats, bool vsAI, Outcome outcome);
+    // Salted PBKDF2; see PasswordHasher. Verification also accepts legacy
+    // unsalted SHA-256 hashes.
+    static QString hashPassword(const QString &password);
+    static bool verifyPassword(const QString &password, const QString &stored);
+    static bool isValidUsername(const QString &username);
+    static QString formatHistory(const QList<GameRecord> &games);
+};
+
+#endif
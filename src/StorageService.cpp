@@ -0,0 +1,54 @@
+#include "StorageService.h"
+#include "RetentionJob.h"
+#include "SnapshotJob.h"
+#include "StartupTrace.h"
+#include <QtConcurrent/QtConcurrent>
+
+StorageService::StorageService(const QString &path, QObject *parent) : QObject(parent) {
+    // Opening the file and running migrations can take a while on slow
+    // storage, so windows show while it happens.
+    connect(&opening, &QFutureWatcher<Database *>::finished, this, [this]() {
+        adopt(opening.result());
+    });
+    opening.setFuture(QtConcurrent::run([path]() {
+        return new Database(path);
+    }));
+}
+
+StorageService::StorageService(Storage *storage, QObject *parent) : QObject(parent), store(storage) {
+}
+
+StorageService::~StorageService() {
+    // Jobs are children and are deleted with this object, but they hold the
+    // database, so they go first.
+    qDeleteAll(findChildren<QObject *>(Qt::FindDirectChildrenOnly));
+    opening.waitForFinished();
+    if (!store && opening.future().resultCount() > 0) {
+        delete opening.result();
+    }
+}
+
+void StorageService::waitForReady() {
+    if (store) {
+        return;
+    }
+    opening.waitForFinished();
+    if (!store) {
+        adopt(opening.result());
+    }
+}
+
+void StorageService::adopt(Database *database) {
+    if (store) {
+        return;
+    }
+    store.reset(database);
+    if (RetentionJob *retention = RetentionJob::fromEnvironment(database, this)) {
+        retention->start();
+    }
+    if (SnapshotJob *snapshot = SnapshotJob::fromEnvironment(database, this)) {
+        snapshot->start();
+    }
+    StartupTrace::mark("database ready");
+    emit ready();
+}
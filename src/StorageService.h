@@ -0,0 +1,34 @@
+#ifndef STORAGESERVICE_H
+#define STORAGESERVICE_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <memory>
+#include "Database.h"
+
+// The application's one storage, shared by every window for the life of the
+// process. Windows borrow storage() and never delete it; logging out and in
+// again reuses the same instance and connections. A Database is opened on a
+// worker thread, and its retention and snapshot jobs start once it is ready.
+class StorageService : public QObject {
+    Q_OBJECT
+public:
+    explicit StorageService(const QString &path = Database::defaultPath(), QObject *parent = nullptr);
+    // Serves an already-open storage, e.g. a MemoryStorage in tests, and
+    // takes ownership of it.
+    explicit StorageService(Storage *storage, QObject *parent = nullptr);
+    ~StorageService() override;
+    // nullptr until ready() has been emitted.
+    Storage *storage() const { return store.get(); }
+    bool isReady() const { return store != nullptr; }
+    void waitForReady();
+signals:
+    void ready();
+private:
+    void adopt(Database *database);
+
+    std::unique_ptr<Storage> store;
+    QFutureWatcher<Database *> opening;
+};
+
+#endif
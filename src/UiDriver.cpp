@@ -0,0 +1,195 @@
+#include "UiDriver.h"
+#include <QCoreApplication>
+#include <QMouseEvent>
+#include <QDebug>
+
+UiDriver::UiDriver(BoardView *board, QObject *parent)
+    : QObject(parent), board(board), randomMoves(0), intervalMs(0), position(0), running(false),
+      inFlight(false), released(false), skipped(0), overrun(0) {
+    timeout.setSingleShot(true);
+    connect(&pacer, &QTimer::timeout, this, &UiDriver::tick);
+    connect(&timeout, &QTimer::timeout, this, [this]() {
+        completeMove(false);
+    });
+}
+
+UiDriver::~UiDriver() {
+    if (running) {
+        board->removeEventFilter(this);
+    }
+}
+
+void UiDriver::setScript(const QVector<int> &cells) {
+    script = cells;
+    randomMoves = 0;
+}
+
+void UiDriver::setRandom(int count, quint32 seed) {
+    script.clear();
+    randomMoves = qMax(0, count);
+    random.seed(seed);
+}
+
+UiDriver *UiDriver::fromEnvironment(BoardView *board, QObject *parent) {
+    const QString spec = qEnvironmentVariable("TICTACTOE_UI_DRIVER");
+    if (spec.isEmpty()) {
+        return nullptr;
+    }
+    const QStringList rate = spec.split('@');
+    const int colon = rate[0].indexOf(':');
+    const QString kind = rate[0].left(colon);
+    const QString arguments = rate[0].mid(colon + 1);
+    bool ok = colon > 0;
+    int interval = 0;
+    if (ok && rate.size() == 2) {
+        interval = rate[1].toInt(&ok);
+    }
+    UiDriver *driver = nullptr;
+    if (ok && kind == "random") {
+        const int count = arguments.toInt(&ok);
+        if (ok) {
+            driver = new UiDriver(board, parent);
+            driver->setRandom(count);
+        }
+    } else if (ok && kind == "script") {
+        QVector<int> cells;
+        for (const QString &cell : arguments.split(',')) {
+            cells.append(cell.toInt(&ok));
+            if (!ok) {
+                break;
+            }
+        }
+        if (ok) {
+            driver = new UiDriver(board, parent);
+            driver->setScript(cells);
+        }
+    }
+    if (!driver) {
+        qDebug() << "UI driver error: cannot parse" << spec;
+        return nullptr;
+    }
+    driver->setInterval(qMax(0, interval));
+    return driver;
+}
+
+void UiDriver::start() {
+    if (running) {
+        return;
+    }
+    running = true;
+    position = 0;
+    board->installEventFilter(this);
+    if (intervalMs > 0) {
+        pacer.start(intervalMs);
+    }
+    tick();
+}
+
+void UiDriver::stop() {
+    if (!running) {
+        return;
+    }
+    running = false;
+    inFlight = false;
+    pacer.stop();
+    timeout.stop();
+    board->removeEventFilter(this);
+    emit finished();
+}
+
+void UiDriver::tick() {
+    if (inFlight) {
+        ++overrun;
+        return;
+    }
+    playNext();
+}
+
+void UiDriver::playNext() {
+    const int total = script.isEmpty() ? randomMoves : static_cast<int>(script.size());
+    int cell = -1;
+    while (position < total && (cell = nextCell()) < 0) {
+        ++position;
+        ++skipped;
+    }
+    if (position >= total) {
+        stop();
+        return;
+    }
+    ++position;
+    const QPointF centre = board->cellRect(cell / board->boardSize(), cell % board->boardSize()).center();
+    const QPointF global = board->mapToGlobal(centre);
+    inFlight = true;
+    released = false;
+    clock.start();
+    timeout.start(RepaintTimeoutMs);
+    QCoreApplication::postEvent(board, new QMouseEvent(QEvent::MouseButtonPress, centre, global,
+                                                       Qt::LeftButton, Qt::LeftButton, Qt::NoModifier));
+    QCoreApplication::postEvent(board, new QMouseEvent(QEvent::MouseButtonRelease, centre, global,
+                                                       Qt::LeftButton, Qt::NoButton, Qt::NoModifier));
+}
+
+int UiDriver::nextCell() {
+    const int size = board->boardSize();
+    if (!script.isEmpty()) {
+        const int cell = script[position];
+        return cell >= 0 && cell < size * size ? cell : -1;
+    }
+    QVector<int> empty;
+    for (int cell = 0; cell < size * size; ++cell) {
+        if (board->mark(cell / size, cell % size) == ' ') {
+            empty.append(cell);
+        }
+    }
+    return empty.isEmpty() ? -1 : empty[random.bounded(static_cast<int>(empty.size()))];
+}
+
+bool UiDriver::eventFilter(QObject *watched, QEvent *event) {
+    if (!inFlight || watched != board) {
+        return false;
+    }
+    if (event->type() == QEvent::MouseButtonRelease) {
+        released = true;
+    } else if (event->type() == QEvent::Paint && released) {
+        // Paint now so the sample includes the paint itself.
+        static_cast<QObject *>(board)->event(event);
+        completeMove(true);
+        return true;
+    }
+    return false;
+}
+
+void UiDriver::completeMove(bool painted) {
+    if (!inFlight) {
+        return;
+    }
+    inFlight = false;
+    timeout.stop();
+    if (painted) {
+        samples.record(clock.nsecsElapsed());
+    } else {
+        ++skipped;
+    }
+    if (intervalMs == 0) {
+        QTimer::singleShot(0, this, [this]() {
+            if (running) {
+                playNext();
+            }
+        });
+    }
+}
+
+QString UiDriver::report() const {
+    QString text = QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+                       .arg("moves", 8).arg("skipped", 8).arg("overruns", 9)
+                       .arg("p50 ms", 10).arg("p90 ms", 10).arg("p99 ms", 10)
+                       .arg("p99.9 ms", 10).arg("max ms", 10);
+    text += QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+                .arg(samples.count(), 8).arg(skipped, 8).arg(overrun, 9)
+                .arg(samples.percentile(50) / 1e6, 10, 'f', 3)
+                .arg(samples.percentile(90) / 1e6, 10, 'f', 3)
+                .arg(samples.percentile(99) / 1e6, 10, 'f', 3)
+                .arg(samples.percentile(99.9) / 1e6, 10, 'f', 3)
+                .arg(samples.max() / 1e6, 10, 'f', 3);
+    return text;
+}
@@ -0,0 +1,75 @@
+#ifndef UIDRIVER_H
+#define UIDRIVER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <QVector>
+#include "BoardView.h"
+#include "QueryStats.h"
+
+// Plays moves into a BoardView the way a user would: each move is a mouse
+// press and release posted to the cell and handled by the event loop like
+// real input. A move's latency runs from posting the press until the board
+// has finished its next paint, so it covers the move handler, any AI reply
+// and save it makes, and the repaint. The board must be visible to paint.
+class UiDriver : public QObject {
+    Q_OBJECT
+public:
+    // A move with no repaint after this long is counted as skipped, e.g. a
+    // scripted move into a taken cell.
+    static constexpr int RepaintTimeoutMs = 1000;
+
+    explicit UiDriver(BoardView *board, QObject *parent = nullptr);
+    ~UiDriver() override;
+    // Cells as row * size + col, played in order.
+    void setScript(const QVector<int> &cells);
+    // `count` moves into cells that are empty when each move is made.
+    void setRandom(int count, quint32 seed = 1);
+    // 0 plays each move as soon as the previous one has repainted; otherwise
+    // a move starts every `ms`, and ticks that find a move still in flight
+    // are counted as overruns.
+    void setInterval(int ms) { intervalMs = ms; }
+    // Configured by $TICTACTOE_UI_DRIVER as "random:<count>" or
+    // "script:<cell>,<cell>,...", optionally followed by "@<interval ms>";
+    // nullptr when unset or malformed.
+    static UiDriver *fromEnvironment(BoardView *board, QObject *parent = nullptr);
+
+    void start();
+    void stop();
+    bool isRunning() const { return running; }
+    const LatencyHistogram &latency() const { return samples; }
+    int movesPlayed() const { return static_cast<int>(samples.count()); }
+    int movesSkipped() const { return skipped; }
+    int overruns() const { return overrun; }
+    // Percentiles of click-to-repaint latency in milliseconds.
+    QString report() const;
+signals:
+    void finished();
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+private:
+    void tick();
+    void playNext();
+    void completeMove(bool painted);
+    int nextCell();
+
+    BoardView *board;
+    QVector<int> script;
+    int randomMoves;
+    QRandomGenerator random;
+    int intervalMs;
+    int position;
+    bool running;
+    bool inFlight;
+    bool released;
+    QElapsedTimer clock;
+    QTimer pacer;
+    QTimer timeout;
+    LatencyHistogram samples;
+    int skipped;
+    int overrun;
+};
+
+#endif
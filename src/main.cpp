@@ -1,9 +1,13 @@
 #include <QApplication>
 #include "AuthWindow.h"
+#include "StartupTrace.h"
 
 int main(int argc, char *argv[]) {
+    StartupTrace::mark("main");
     QApplication app(argc, argv);
-    AuthWindow authWindow;
+    StartupTrace::mark("application created");
+    StorageService storage;
+    AuthWindow authWindow(&storage);
     authWindow.show();
     return app.exec();
 }
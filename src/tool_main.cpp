@@ -0,0 +1,253 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include "Database.h"
+#include "PasswordHasher.h"
+#include "DataTransfer.h"
+#include "GameController.h"
+#include "GameLog.h"
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("TicTacToeTool");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Maintenance commands for the TicTacToe database.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "recompute-ratings | calibrate-password-hash | "
+                                            "export-users | export-games | import-users | import-games | "
+                                            "apply-retention | enable-incremental-vacuum | backup | reshard | "
+                                            "benchmark-games | benchmark-gamelog");
+    parser.addPositionalArgument("file", "Data file for export/import commands (- for stdout/stdin), backup target "
+                                         "or game log directory (benchmark-gamelog, default a temporary one).",
+                                 "[file]");
+    QCommandLineOption targetOption("target-ms", "Time one password hash should take (calibrate-password-hash).",
+                                    "milliseconds", "250");
+    parser.addOption(targetOption);
+    QCommandLineOption daysOption("days", "Keep games newer than this many days (apply-retention).", "days", "365");
+    parser.addOption(daysOption);
+    QCommandLineOption shardsOption("shards", "Number of game shard files, 1 for none (reshard).", "count", "1");
+    parser.addOption(shardsOption);
+    QCommandLineOption gamesOption("games", "Games to play against the AI (benchmark-games).", "count", "1000");
+    parser.addOption(gamesOption);
+    QCommandLineOption recordsOption("records", "Records to append (benchmark-gamelog).", "count", "4000000");
+    parser.addOption(recordsOption);
+    QCommandLineOption formatOption("format", "jsonl or csv; defaults to the file suffix.", "format");
+    parser.addOption(formatOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const QStringList args = parser.positionalArguments();
+    if (args.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    const QString command = args.first();
+    if (command == "recompute-ratings") {
+        Database db;
+        if (!db.recomputeRatings()) {
+            out << "Rating recomputation failed.\n";
+            return 1;
+        }
+        out << "Ratings recomputed.\n";
+        return 0;
+    }
+
+    if (command == "calibrate-password-hash") {
+        int target = parser.value(targetOption).toInt();
+        if (target <= 0) {
+            out << "Invalid --target-ms value.\n";
+            return 1;
+        }
+        int iterations = PasswordHasher::calibrate(target);
+        QElapsedTimer timer;
+        timer.start();
+        PasswordHasher::hash("calibration", iterations);
+        out << "PBKDF2-SHA256 iterations for ~" << target << " ms: " << iterations
+            << " (measured " << timer.elapsed() << " ms)\n"
+            << "Set TICTACTOE_PBKDF2_ITERATIONS=" << iterations << " to use it.\n";
+        return 0;
+    }
+
+    if (command == "apply-retention") {
+        int days = parser.value(daysOption).toInt();
+        if (days <= 0) {
+            out << "Invalid --days value.\n";
+            return 1;
+        }
+        Database db;
+        RetentionResult result = db.applyRetention(QDateTime::currentDateTimeUtc().addDays(-days));
+        out << (result.ok ? "Archived " : "Retention failed after archiving ") << result.archived
+            << " games, reclaimed " << result.reclaimedPages << " pages.\n";
+        return result.ok ? 0 : 1;
+    }
+
+    if (command == "enable-incremental-vacuum") {
+        Database db;
+        if (!db.enableIncrementalVacuum()) {
+            out << "VACUUM failed.\n";
+            return 1;
+        }
+        out << "Incremental vacuum enabled.\n";
+        return 0;
+    }
+
+    if (command == "backup") {
+        if (args.size() < 2) {
+            out << "backup needs a target file.\n";
+            return 1;
+        }
+        Database db;
+        QElapsedTimer timer;
+        timer.start();
+        if (!db.backupTo(args.at(1))) {
+            out << "Backup failed.\n";
+            return 1;
+        }
+        out << "Backed up " << db.path() << " to " << args.at(1) << " in " << timer.elapsed() << " ms.\n";
+        return 0;
+    }
+
+    if (command == "reshard") {
+        bool ok = false;
+        int count = parser.value(shardsOption).toInt(&ok);
+        if (!ok || count < 1 || count > Database::MaxShards) {
+            out << "Invalid --shards value.\n";
+            return 1;
+        }
+        Database db;
+        QElapsedTimer timer;
+        timer.start();
+        if (!db.reshard(count)) {
+            out << "Reshard failed.\n";
+            return 1;
+        }
+        out << "Games of " << db.path() << " now in " << count << " shard(s), took " << timer.elapsed() << " ms.\n";
+        return 0;
+    }
+
+    if (command == "benchmark-games") {
+        bool ok = false;
+        const int games = parser.value(gamesOption).toInt(&ok);
+        if (!ok || games < 1) {
+            out << "Invalid --games value.\n";
+            return 1;
+        }
+        // Random moves against the AI, headless and unsaved.
+        GameController controller(nullptr);
+        int finished = 0;
+        int moves = 0;
+        QObject::connect(&controller, &GameController::gameOver, [&finished]() { ++finished; });
+        QObject::connect(&controller, &GameController::moveApplied, [&moves]() { ++moves; });
+        controller.startGame(true);
+        QRandomGenerator random(1);
+        QElapsedTimer timer;
+        timer.start();
+        while (finished < games) {
+            const int cell = random.bounded(9);
+            controller.playMove(cell / 3, cell % 3);
+        }
+        const double seconds = qMax<qint64>(1, timer.elapsed()) / 1000.0;
+        out << "Played " << games << " games (" << moves << " moves) in " << timer.elapsed() << " ms, "
+            << qRound(games / seconds) << " games/s.\n";
+        return 0;
+    }
+
+    if (command == "benchmark-gamelog") {
+        bool ok = false;
+        const qint64 records = parser.value(recordsOption).toLongLong(&ok);
+        if (!ok || records < 1) {
+            out << "Invalid --records value.\n";
+            return 1;
+        }
+        QTemporaryDir scratch;
+        const QString directory = args.size() > 1 ? args.at(1) : scratch.path();
+        GameLog log(directory);
+        if (!log.isOpen()) {
+            out << "Cannot open game log in " << directory << ".\n";
+            return 1;
+        }
+        // Records are built up front so only the appends are timed.
+        const int variants = 1024;
+        QVector<GameLogRecord> prepared;
+        QRandomGenerator random(1);
+        for (int i = 0; i < variants; ++i) {
+            prepared.append(GameLog::makeRecord(random.bounded(100000), {4, 0, 8, 2, 6}, i % 3,
+                                                i % 2 == 0, 'X', 1700000000000LL + i));
+        }
+        QElapsedTimer timer;
+        timer.start();
+        for (qint64 i = 0; i < records; ++i) {
+            if (!log.append(prepared[i % variants])) {
+                out << "Append failed after " << i << " records.\n";
+                return 1;
+            }
+        }
+        const qint64 appendNanos = qMax<qint64>(1, timer.nsecsElapsed());
+        timer.restart();
+        qint64 scanned = 0;
+        log.scan([&scanned](const GameLogRecord &) { ++scanned; });
+        const qint64 scanNanos = qMax<qint64>(1, timer.nsecsElapsed());
+        out << "Appended " << records << " records in " << appendNanos / 1000000 << " ms, "
+            << qRound64(records * 1e9 / appendNanos) << " records/s.\n"
+            << "Scanned " << scanned << " records in " << scanNanos / 1000000 << " ms, "
+            << qRound64(scanned * 1e9 / scanNanos) << " records/s.\n";
+        return 0;
+    }
+
+    const bool exporting = command == "export-users" || command == "export-games";
+    const bool importing = command == "import-users" || command == "import-games";
+    if (exporting || importing) {
+        // Progress goes to stderr so an export can stream to stdout.
+        QTextStream err(stderr);
+        if (args.size() < 2) {
+            err << command << " needs a file argument.\n";
+            return 1;
+        }
+        const QString path = args.at(1);
+        DataTransfer::Format format = DataTransfer::formatFor(path);
+        if (parser.isSet(formatOption)) {
+            const QString name = parser.value(formatOption);
+            if (name != "csv" && name != "jsonl") {
+                err << "Unknown format: " << name << "\n";
+                return 1;
+            }
+            format = name == "csv" ? DataTransfer::Csv : DataTransfer::JsonLines;
+        }
+        QFile file;
+        bool opened = false;
+        if (path == "-") {
+            opened = exporting ? file.open(stdout, QIODevice::WriteOnly) : file.open(stdin, QIODevice::ReadOnly);
+        } else {
+            file.setFileName(path);
+            opened = file.open(exporting ? QIODevice::WriteOnly | QIODevice::Truncate : QIODevice::ReadOnly);
+        }
+        if (!opened) {
+            err << "Cannot open " << path << ": " << file.errorString() << "\n";
+            return 1;
+        }
+
+        Database db;
+        DataTransfer transfer(&db);
+        DataTransfer::Result result =
+            command == "export-users" ? transfer.exportUsers(&file, format)
+            : command == "export-games" ? transfer.exportGames(&file, format)
+            : command == "import-users" ? transfer.importUsers(&file, format)
+            : transfer.importGames(&file, format);
+        file.close();
+        err << command << (result.ok ? "" : " failed") << ": " << result.rows << " rows";
+        if (result.skipped > 0) {
+            err << ", " << result.skipped << " skipped";
+        }
+        err << " in " << result.nanos / 1000000 << " ms ("
+            << qint64(result.rowsPerSecond()) << " rows/sec)\n";
+        return result.ok ? 0 : 1;
+    }
+
+    out << "Unknown command: " << command << "\n";
+    return 1;
+}
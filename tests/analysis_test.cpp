@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <iostream>
+#include "MoveAnalysis.h"
+#include "MoveAnalyzer.h"
+
+namespace {
+
+QVector<char> parse(const char *rows) {
+    QVector<char> board;
+    for (const char *c = rows; *c; ++c) {
+        board.append(*c == '.' ? ' ' : *c);
+    }
+    return board;
+}
+
+CellEvaluation at(const QVector<CellEvaluation> &evaluations, int cell) {
+    for (const CellEvaluation &evaluation : evaluations) {
+        if (evaluation.cell == cell) {
+            return evaluation;
+        }
+    }
+    return CellEvaluation();
+}
+
+}
+
+TEST(MoveAnalysisTest, EmptyBoardIsADrawEverywhere) {
+    std::atomic_bool cancelled(false);
+    MoveAnalysis analysis(parse("........."), 3);
+    const QVector<CellEvaluation> evaluations = analysis.evaluate('X', 9, cancelled);
+    ASSERT_EQ(evaluations.size(), 9);
+    for (const CellEvaluation &evaluation : evaluations) {
+        EXPECT_EQ(evaluation.outcome, CellEvaluation::Draw);
+        EXPECT_TRUE(evaluation.exact);
+    }
+}
+
+TEST(MoveAnalysisTest, FindsWinsAndLossesWithDistances) {
+    std::atomic_bool cancelled(false);
+    // X to move: 2 completes the top row, and any other move lets O take 2
+    // and complete the right-hand column.
+    MoveAnalysis analysis(parse("XX." "..O" "..O"), 3);
+    const QVector<CellEvaluation> evaluations = analysis.evaluate('X', 9, cancelled);
+    EXPECT_EQ(at(evaluations, 2).outcome, CellEvaluation::Win);
+    EXPECT_EQ(at(evaluations, 2).distance, 1);
+    EXPECT_EQ(at(evaluations, 3).outcome, CellEvaluation::Loss);
+    EXPECT_EQ(at(evaluations, 3).distance, 2);
+}
+
+TEST(MoveAnalysisTest, ShallowSearchLeavesUnprovenCellsUnknown) {
+    std::atomic_bool cancelled(false);
+    MoveAnalysis analysis(parse("........."), 3);
+    const QVector<CellEvaluation> evaluations = analysis.evaluate('X', 2, cancelled);
+    for (const CellEvaluation &evaluation : evaluations) {
+        EXPECT_EQ(evaluation.outcome, CellEvaluation::Unknown);
+        EXPECT_FALSE(evaluation.exact);
+    }
+    cancelled = true;
+    EXPECT_TRUE(analysis.evaluate('X', 9, cancelled).isEmpty());
+}
+
+TEST(MoveAnalyzerTest, RefinesUntilProven) {
+    MoveAnalyzer analyzer;
+    QSignalSpy updated(&analyzer, &MoveAnalyzer::updated);
+    QSignalSpy finished(&analyzer, &MoveAnalyzer::finished);
+    analyzer.analyze(parse("X...O...."), 3, 'X');
+    ASSERT_TRUE(finished.wait(10000));
+    EXPECT_GT(updated.size(), 1);
+    EXPECT_FALSE(analyzer.isRunning());
+    for (const CellEvaluation &evaluation : analyzer.evaluations()) {
+        EXPECT_TRUE(evaluation.exact);
+    }
+}
+
+TEST(MoveAnalyzerTest, NewPositionCancelsTheOldOne) {
+    MoveAnalyzer analyzer;
+    QSignalSpy finished(&analyzer, &MoveAnalyzer::finished);
+    // A 9 x 9 board is far too big to finish at depth 12; only cancellation
+    // stops it.
+    QVector<char> large(81, ' ');
+    large[40] = 'X';
+    analyzer.analyze(large, 9, 'O');
+    QElapsedTimer clock;
+    clock.start();
+    analyzer.analyze(parse("XX." "..O" "..O"), 3, 'X');
+    ASSERT_TRUE(finished.wait(10000));
+    std::cout << "Switched positions in " << clock.elapsed() << " ms" << std::endl;
+    EXPECT_EQ(finished.size(), 1);
+    EXPECT_EQ(analyzer.evaluations().size(), 5);
+    EXPECT_EQ(at(analyzer.evaluations(), 2).outcome, CellEvaluation::Win);
+}
+
+TEST(MoveAnalyzerTest, LargeBoardReportsShallowResultsQuickly) {
+    MoveAnalyzer analyzer;
+    QSignalSpy updated(&analyzer, &MoveAnalyzer::updated);
+    QVector<char> large(15 * 15, ' ');
+    large[7 * 15 + 7] = 'X';
+    large[7 * 15 + 8] = 'O';
+    analyzer.analyze(large, 15, 'X');
+    ASSERT_TRUE(updated.wait(5000));
+    EXPECT_EQ(analyzer.depth(), 1);
+    EXPECT_EQ(analyzer.evaluations().size(), 15 * 15 - 2);
+    // Destroying the analyzer mid-search cancels it rather than waiting.
+}
+
+int main(int argc, char **argv) {
+    QApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
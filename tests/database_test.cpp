@@ -1,37 +1,36 @@
 #include <gtest/gtest.h>
+#include <QSet>
 #include <QApplication>
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QFile>
 #include <QDir>
+#include <QThread>
+#include <QAtomicInt>
 #include "Database.h"
+#include "MemoryStorage.h"
+#include "BoardCodec.h"
+#include "PasswordHasher.h"
+#include "AuthService.h"
+#include "DataTransfer.h"
+#include "SnapshotJob.h"
+#include <QBuffer>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
 
 class DatabaseTest : public ::testing::Test {
 protected:
     void SetUp() override {
-        // Remove any existing test database
-        if (QFile::exists("test_tictactoe.db")) {
-            QFile::remove("test_tictactoe.db");
-        }
-        
-        // Create a separate database connection for testing
-        if (QSqlDatabase::contains("qt_sql_default_connection")) {
-            QSqlDatabase::removeDatabase("qt_sql_default_connection");
-        }
-        
-        db = new Database();
+        // Each instance gets its own connection, so every test starts from an empty in-memory database
+        db = new Database(":memory:");
     }
 
     void TearDown() override {
         delete db;
-        
-        // Clean up test database
-        if (QFile::exists("test_tictactoe.db")) {
-            QFile::remove("test_tictactoe.db");
-        }
-        if (QFile::exists("tictactoe.db")) {
-            QFile::remove("tictactoe.db");
-        }
     }
 
     Database* db;
@@ -276,6 +275,1186 @@ TEST_F(DatabaseTest, FullWorkflow_RegisterAuthenticateSaveRetrieve_Success) {
     EXPECT_EQ(gameCount, 3);
 }
 
+// Test incrementally maintained user statistics
+TEST_F(DatabaseTest, GetUserStats_NoGames_ReturnsZeroes) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+
+    UserStats stats = db->getUserStats(userId);
+    EXPECT_EQ(stats.totalGames, 0);
+    EXPECT_EQ(stats.wins, 0);
+    EXPECT_EQ(stats.bestStreak, 0);
+}
+
+TEST_F(DatabaseTest, GetUserStats_TracksTotalsModesAndStreaks) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+    char board[3][3] = {
+        {'X', 'X', 'X'},
+        {'O', 'O', ' '},
+        {' ', ' ', ' '}
+    };
+
+    EXPECT_TRUE(db->saveGame(userId, board, "X", true, 'X'));
+    EXPECT_TRUE(db->saveGame(userId, board, "X", true, 'X'));
+    EXPECT_TRUE(db->saveGame(userId, board, "X", false, 'X'));
+    EXPECT_TRUE(db->saveGame(userId, board, "O", true, 'X'));
+    EXPECT_TRUE(db->saveGame(userId, board, "Tie", false, 'O'));
+    EXPECT_TRUE(db->saveGame(userId, board, "O", false, 'O'));
+
+    UserStats stats = db->getUserStats(userId);
+    EXPECT_EQ(stats.totalGames, 6);
+    EXPECT_EQ(stats.wins, 4);
+    EXPECT_EQ(stats.losses, 1);
+    EXPECT_EQ(stats.ties, 1);
+    EXPECT_EQ(stats.aiGames, 3);
+    EXPECT_EQ(stats.aiWins, 2);
+    EXPECT_EQ(stats.aiLosses, 1);
+    EXPECT_EQ(stats.pvpGames, 3);
+    EXPECT_EQ(stats.pvpWins, 2);
+    EXPECT_EQ(stats.pvpTies, 1);
+    EXPECT_EQ(stats.currentStreak, 1);
+    EXPECT_EQ(stats.bestStreak, 3);
+}
+
+TEST_F(DatabaseTest, GetUserStats_InvalidSaveDoesNotCount) {
+    char board[3][3] = {
+        {'X', 'X', 'X'},
+        {' ', ' ', ' '},
+        {' ', ' ', ' '}
+    };
+    EXPECT_FALSE(db->saveGame(-1, board, "Win"));
+
+    UserStats stats = db->getUserStats(-1);
+    EXPECT_EQ(stats.totalGames, 0);
+}
+
+// Test Elo ratings and leaderboard queries
+TEST_F(DatabaseTest, Ratings_NewUserStartsAtInitialRating) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+
+    EXPECT_DOUBLE_EQ(db->getRating(userId, Database::PvPRating), Database::InitialRating);
+    EXPECT_DOUBLE_EQ(db->getRating(userId, Database::AIRating), Database::InitialRating);
+}
+
+TEST_F(DatabaseTest, Ratings_SaveGameUpdatesOnlyMatchingPool) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+    char board[3][3] = {
+        {'X', 'X', 'X'},
+        {'O', 'O', ' '},
+        {' ', ' ', ' '}
+    };
+
+    EXPECT_TRUE(db->saveGame(userId, board, "X", true, 'X'));
+    EXPECT_GT(db->getRating(userId, Database::AIRating), Database::InitialRating);
+    EXPECT_DOUBLE_EQ(db->getRating(userId, Database::PvPRating), Database::InitialRating);
+
+    EXPECT_TRUE(db->saveGame(userId, board, "O", false, 'X'));
+    EXPECT_LT(db->getRating(userId, Database::PvPRating), Database::InitialRating);
+}
+
+TEST_F(DatabaseTest, Ratings_LeaderboardAndRankAreOrdered) {
+    EXPECT_TRUE(db->registerUser("winner", "password1"));
+    EXPECT_TRUE(db->registerUser("loser", "password2"));
+    EXPECT_TRUE(db->registerUser("idle", "password3"));
+    int winner = db->authenticate("winner", "password1");
+    int loser = db->authenticate("loser", "password2");
+    int idle = db->authenticate("idle", "password3");
+    char board[3][3] = {
+        {'X', 'X', 'X'},
+        {'O', 'O', ' '},
+        {' ', ' ', ' '}
+    };
+
+    EXPECT_TRUE(db->saveGame(winner, board, "Win"));
+    EXPECT_TRUE(db->saveGame(loser, board, "Loss"));
+
+    QList<RatingEntry> top = db->getLeaderboard(Database::PvPRating, 2);
+    ASSERT_EQ(top.size(), 2);
+    EXPECT_EQ(top[0].userId, winner);
+    EXPECT_EQ(top[1].userId, idle);
+    EXPECT_EQ(db->getRank(winner, Database::PvPRating), 1);
+    EXPECT_EQ(db->getRank(loser, Database::PvPRating), 3);
+    EXPECT_EQ(db->getRank(-1, Database::PvPRating), -1);
+}
+
+TEST_F(DatabaseTest, Ratings_BucketedRankMatchesFullCount) {
+    char win[3][3] = {{'X', 'X', 'X'}, {'O', 'O', ' '}, {' ', ' ', ' '}};
+    QList<int> userIds;
+    for (int i = 0; i < 24; ++i) {
+        QString name = QString("ranked%1").arg(i);
+        ASSERT_TRUE(db->registerUser(name, "password"));
+        userIds.append(db->authenticate(name, "password"));
+        for (int game = 0; game < i % 7; ++game) {
+            ASSERT_TRUE(db->saveGame(userIds.last(), win, "X", i % 2 == 0));
+        }
+        for (int game = 0; game < i % 4; ++game) {
+            ASSERT_TRUE(db->saveGame(userIds.last(), win, "O", i % 3 == 0));
+        }
+    }
+    auto expectRanks = [&](const char *stage) {
+        for (Database::RatingPool pool : {Database::PvPRating, Database::AIRating}) {
+            for (int userId : userIds) {
+                const double rating = db->getRating(userId, pool);
+                int above = 0;
+                for (int other : userIds) {
+                    above += db->getRating(other, pool) > rating;
+                }
+                EXPECT_EQ(db->getRank(userId, pool), above + 1) << stage << " user " << userId << " pool " << pool;
+            }
+        }
+    };
+    expectRanks("incremental");
+    ASSERT_TRUE(db->recomputeRatings());
+    expectRanks("recomputed");
+    ASSERT_TRUE(db->reshard(3));
+    expectRanks("sharded");
+    ASSERT_TRUE(db->reshard(1));
+    expectRanks("unsharded");
+}
+
+TEST(DatabaseRatingTest, BucketsSplitOnWholePoints) {
+    const qint64 width = Database::RatingBucketWidth;
+    EXPECT_EQ(Database::ratingBucket(0.0), 0);
+    EXPECT_EQ(Database::ratingBucket(width - 0.001), 0);
+    EXPECT_EQ(Database::ratingBucket(double(width)), 1);
+    EXPECT_EQ(Database::ratingBucket(-0.5), -1);
+    EXPECT_EQ(Database::ratingBucket(-double(width)), -1);
+    EXPECT_EQ(Database::ratingBucket(-width - 0.5), -2);
+
+    QSqlDatabase raw = QSqlDatabase::addDatabase("QSQLITE", "bucket_sql");
+    {
+        ASSERT_TRUE(raw.open());
+        QSqlQuery query(raw);
+        for (double rating : {0.0, 15.999, 16.0, 1216.4, -0.5, -16.0, -16.5}) {
+            ASSERT_TRUE(query.exec(QString("SELECT %1;").arg(Database::ratingBucketSql(QString::number(rating, 'g', 17))))
+                        && query.next());
+            EXPECT_EQ(query.value(0).toLongLong(), Database::ratingBucket(rating)) << rating;
+        }
+        query.finish();
+        raw.close();
+    }
+    QSqlDatabase::removeDatabase("bucket_sql");
+}
+
+TEST_F(DatabaseTest, Ratings_RecomputeReproducesIncrementalRatings) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+    char board[3][3] = {
+        {'X', 'X', 'X'},
+        {'O', 'O', ' '},
+        {' ', ' ', ' '}
+    };
+    EXPECT_TRUE(db->saveGame(userId, board, "X", true, 'X'));
+    EXPECT_TRUE(db->saveGame(userId, board, "Tie", true, 'X'));
+    EXPECT_TRUE(db->saveGame(userId, board, "O", false, 'X'));
+
+    double ai = db->getRating(userId, Database::AIRating);
+    double pvp = db->getRating(userId, Database::PvPRating);
+    EXPECT_TRUE(db->recomputeRatings());
+    EXPECT_NEAR(db->getRating(userId, Database::AIRating), ai, 1e-9);
+    EXPECT_NEAR(db->getRating(userId, Database::PvPRating), pvp, 1e-9);
+}
+
+// Test integer timestamps and time-range queries
+TEST_F(DatabaseTest, GetGamesBetween_ReturnsGamesInsideRange) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+    char board[3][3] = {
+        {'X', 'O', 'X'},
+        {'O', 'X', 'O'},
+        {'X', 'O', 'X'}
+    };
+
+    QDateTime before = QDateTime::currentDateTimeUtc().addSecs(-1);
+    EXPECT_TRUE(db->saveGame(userId, board, "Win"));
+    EXPECT_TRUE(db->saveGame(userId, board, "Loss"));
+    QDateTime after = QDateTime::currentDateTimeUtc().addSecs(1);
+
+    QList<GameRecord> games = db->getGamesBetween(userId, before, after);
+    ASSERT_EQ(games.size(), 2);
+    EXPECT_EQ(games[0].board, "XOXOXOXOX");
+    EXPECT_EQ(games[0].result, "Win");
+    EXPECT_EQ(games[1].result, "Loss");
+    EXPECT_LE(games[0].playedAt, games[1].playedAt);
+    EXPECT_GE(games[0].playedAt, before);
+
+    EXPECT_TRUE(db->getGamesBetween(userId, after, after.addDays(1)).isEmpty());
+    EXPECT_EQ(db->getGamesThisWeek(userId).size(), 2);
+}
+
+// Test keyset paging over a user's games
+TEST_F(DatabaseTest, GetRecentGames_PagesNewestFirstWithoutGaps) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+    char board[3][3] = {
+        {'X', 'O', 'X'},
+        {'O', 'X', 'O'},
+        {'X', 'O', 'X'}
+    };
+    for (int i = 0; i < 25; ++i) {
+        EXPECT_TRUE(db->saveGame(userId, board, i % 2 ? "Loss" : "Win"));
+    }
+
+    QList<GameRecord> seen;
+    QList<GameRecord> page = db->getRecentGames(userId, 10);
+    while (!page.isEmpty()) {
+        EXPECT_LE(page.size(), 10);
+        seen.append(page);
+        page = db->getRecentGames(userId, 10, seen.last().playedAt, seen.last().id);
+    }
+    ASSERT_EQ(seen.size(), 25);
+    QSet<qint64> ids;
+    for (int i = 0; i < seen.size(); ++i) {
+        ids.insert(seen[i].id);
+        if (i > 0) {
+            EXPECT_TRUE(seen[i].playedAt < seen[i - 1].playedAt ||
+                        (seen[i].playedAt == seen[i - 1].playedAt && seen[i].id < seen[i - 1].id));
+        }
+    }
+    EXPECT_EQ(ids.size(), 25);
+    EXPECT_TRUE(db->getRecentGames(userId + 1, 10).isEmpty());
+}
+
+// Test storage backends side by side
+TEST_F(DatabaseTest, SeparateInstances_HaveIndependentConnections) {
+    Database other(":memory:");
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    EXPECT_EQ(other.authenticate("testuser", "testpassword"), -1);
+    EXPECT_TRUE(other.registerUser("testuser", "testpassword"));
+}
+
+TEST_F(DatabaseTest, FileBackedDatabase_PersistsAcrossInstances) {
+    QString path = QDir::temp().filePath(QString("tictactoe_test_%1.db").arg(QCoreApplication::applicationPid()));
+    QFile::remove(path);
+    {
+        Database fileDb(path);
+        EXPECT_EQ(fileDb.path(), path);
+        EXPECT_TRUE(fileDb.registerUser("testuser", "testpassword"));
+    }
+    {
+        Database fileDb(path);
+        EXPECT_GT(fileDb.authenticate("testuser", "testpassword"), 0);
+    }
+    QFile::remove(path);
+}
+
+TEST(MemoryStorageTest, RegisterAuthenticateAndSave) {
+    MemoryStorage storage;
+    EXPECT_TRUE(storage.registerUser("testuser", "testpassword"));
+    EXPECT_FALSE(storage.registerUser("testuser", "other"));
+    EXPECT_FALSE(storage.registerUser("", "password"));
+    int userId = storage.authenticate("testuser", "testpassword");
+    EXPECT_GT(userId, 0);
+    EXPECT_EQ(storage.authenticate("testuser", "wrongpassword"), -1);
+
+    char board[3][3] = {
+        {'X', 'O', 'X'},
+        {'O', 'X', 'O'},
+        {'X', 'O', 'X'}
+    };
+    EXPECT_EQ(storage.getGameHistory(userId), "No games played.");
+    EXPECT_FALSE(storage.saveGame(-1, board, "Win"));
+    EXPECT_TRUE(storage.saveGame(userId, board, "X", true, 'X'));
+    EXPECT_TRUE(storage.saveGame(userId, board, "Tie", false, 'X'));
+
+    QString history = storage.getGameHistory(userId);
+    EXPECT_EQ(history.count("Game at"), 2);
+    EXPECT_TRUE(history.contains("XOXOXOXOX"));
+
+    UserStats stats = storage.getUserStats(userId);
+    EXPECT_EQ(stats.totalGames, 2);
+    EXPECT_EQ(stats.aiWins, 1);
+    EXPECT_EQ(stats.pvpTies, 1);
+    EXPECT_EQ(storage.getGamesThisWeek(userId).size(), 2);
+}
+
+// Test per-operation query statistics and the slow-query log
+TEST(LatencyHistogramTest, PercentilesStayWithinBucketPrecision) {
+    LatencyHistogram histogram;
+    for (qint64 i = 1; i <= 1000; ++i) {
+        histogram.record(i * 1000);
+    }
+    EXPECT_EQ(histogram.count(), 1000);
+    EXPECT_EQ(histogram.max(), 1000000);
+    EXPECT_NEAR(histogram.percentile(50), 500000, 500000 * 0.07);
+    EXPECT_NEAR(histogram.percentile(99), 990000, 990000 * 0.07);
+    EXPECT_EQ(histogram.percentile(100), 1000000);
+}
+
+TEST_F(DatabaseTest, QueryStats_RecordsCallsAndRows) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+    char board[3][3] = {
+        {'X', 'O', 'X'},
+        {'O', 'X', 'O'},
+        {'X', 'O', 'X'}
+    };
+    EXPECT_TRUE(db->saveGame(userId, board, "Win"));
+    EXPECT_TRUE(db->saveGame(userId, board, "Loss"));
+    db->getGameHistory(userId);
+
+    QHash<QString, QueryStats::Summary> byName;
+    for (const QueryStats::Summary &summary : db->queryStats().summaries()) {
+        byName.insert(summary.operation, summary);
+    }
+    EXPECT_EQ(byName.value("saveGame").calls, 2);
+    EXPECT_EQ(byName.value("getGameHistory").calls, 1);
+    EXPECT_EQ(byName.value("getGameHistory").rows, 2);
+    EXPECT_GE(byName.value("saveGame").max, byName.value("saveGame").p50);
+    EXPECT_TRUE(db->queryStats().report().contains("saveGame"));
+}
+
+TEST(QueryStatsTest, SlowQueryLogRecordsShapesNotValues) {
+    QString path = QDir::temp().filePath(QString("tictactoe_slow_%1.log").arg(QCoreApplication::applicationPid()));
+    QFile::remove(path);
+    QueryStats stats;
+    stats.setSlowQueryLog(path);
+    stats.setSlowQueryThreshold(0);
+    EXPECT_FALSE(stats.slowQueryLogEnabled());
+    stats.setSlowQueryThreshold(5);
+    EXPECT_EQ(stats.slowQueryThreshold(), 5);
+
+    QList<QueryStats::Statement> statements = {{"SELECT id FROM users WHERE password = ?", {QString("secret"), 42}}};
+    stats.record(QLatin1String("fast"), 1000000, 1, statements);
+    stats.record(QLatin1String("slow"), 7000000, 1, statements);
+
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    QString log = QString::fromUtf8(file.readAll());
+    EXPECT_FALSE(log.contains("fast"));
+    EXPECT_TRUE(log.contains("slow"));
+    EXPECT_TRUE(log.contains("SELECT id FROM users"));
+    EXPECT_TRUE(log.contains("[text(6), int]"));
+    EXPECT_FALSE(log.contains("secret"));
+    file.close();
+    QFile::remove(path);
+}
+
+// Test integer board encoding
+TEST(BoardCodecTest, EveryPositionRoundTrips) {
+    for (int code = 0; code < BoardCodec::PositionCount; ++code) {
+        char board[3][3];
+        BoardCodec::decode(code, board);
+        ASSERT_EQ(BoardCodec::encode(board), code);
+        ASSERT_EQ(BoardCodec::fromString(BoardCodec::toString(code)), code);
+    }
+}
+
+TEST(BoardCodecTest, EncodesCellsAsBase3Digits) {
+    char board[3][3] = {
+        {' ', ' ', ' '},
+        {' ', ' ', ' '},
+        {' ', 'X', 'O'}
+    };
+    EXPECT_EQ(BoardCodec::encode(board), 1 * 3 + 2);
+    EXPECT_EQ(BoardCodec::toString(0), "         ");
+    EXPECT_EQ(BoardCodec::fromString("OOOOOOOOO"), BoardCodec::PositionCount - 1);
+}
+
+TEST(BoardCodecTest, PacksLargeBoardsIntoTwoMasks) {
+    QVector<char> cells(19 * 19, ' ');
+    cells[0] = 'X';
+    cells[180] = 'O';
+    cells[360] = 'X';
+    QByteArray packed = BoardCodec::pack(cells);
+    EXPECT_EQ(packed.size(), 2 * 46);
+    EXPECT_EQ(BoardCodec::unpack(packed, 19 * 19), cells);
+}
+
+TEST_F(DatabaseTest, SaveGame_StoresBoardAsIntegerCode) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+    char board[3][3] = {
+        {'X', 'O', ' '},
+        {' ', 'X', ' '},
+        {'O', ' ', 'X'}
+    };
+    EXPECT_TRUE(db->saveGame(userId, board, "Win"));
+
+    QList<GameRecord> games = db->getGamesThisWeek(userId);
+    ASSERT_EQ(games.size(), 1);
+    EXPECT_EQ(games[0].board, "XO  X O X");
+    EXPECT_EQ(BoardCodec::fromString(games[0].board), BoardCodec::encode(board));
+}
+
+// Test symmetry-reduced position statistics
+TEST(BoardCodecTest, CanonicalIsSharedBySymmetricPositions) {
+    char corner[3][3] = {
+        {'X', ' ', ' '},
+        {' ', ' ', ' '},
+        {' ', ' ', ' '}
+    };
+    char otherCorner[3][3] = {
+        {' ', ' ', ' '},
+        {' ', ' ', ' '},
+        {' ', ' ', 'X'}
+    };
+    char edge[3][3] = {
+        {' ', 'X', ' '},
+        {' ', ' ', ' '},
+        {' ', ' ', ' '}
+    };
+    int canonical = BoardCodec::canonical(BoardCodec::encode(corner));
+    EXPECT_EQ(BoardCodec::canonical(BoardCodec::encode(otherCorner)), canonical);
+    EXPECT_NE(BoardCodec::canonical(BoardCodec::encode(edge)), canonical);
+    EXPECT_LE(canonical, BoardCodec::encode(corner));
+    EXPECT_EQ(BoardCodec::canonical(canonical), canonical);
+
+    QVector<int> moves = {4, 0, 8, 2, 6, 3, 5, 7, 1};
+    EXPECT_EQ(BoardCodec::unpackMoves(BoardCodec::packMoves(moves)), moves);
+    EXPECT_TRUE(BoardCodec::unpackMoves(0).isEmpty());
+}
+
+static void expectPositionStatsAggregate(Storage &storage, int userId) {
+    char win[3][3] = {
+        {'X', 'O', ' '},
+        {'X', 'O', ' '},
+        {'X', ' ', ' '}
+    };
+    char loss[3][3] = {
+        {' ', ' ', ' '},
+        {' ', 'O', ' '},
+        {' ', ' ', 'X'}
+    };
+    EXPECT_TRUE(storage.saveGame(userId, win, "X", false, 'X', {0, 1, 3, 4, 6}));
+    EXPECT_TRUE(storage.saveGame(userId, loss, "O", true, 'X', {8, 4}));
+
+    // Both games opened in a corner.
+    char corner[3][3] = {
+        {' ', ' ', 'X'},
+        {' ', ' ', ' '},
+        {' ', ' ', ' '}
+    };
+    PositionStats opening = storage.getPositionStats(corner);
+    EXPECT_EQ(opening.occurrences, 2);
+    EXPECT_EQ(opening.xWins, 1);
+    EXPECT_EQ(opening.oWins, 1);
+    EXPECT_EQ(opening.ties, 0);
+
+    PositionStats finished = storage.getPositionStats(win);
+    EXPECT_EQ(finished.occurrences, 1);
+    EXPECT_EQ(finished.xWins, 1);
+
+    // Without moves only the final board is counted.
+    char tie[3][3] = {
+        {'X', 'O', 'X'},
+        {'X', 'O', 'O'},
+        {'O', 'X', 'X'}
+    };
+    EXPECT_TRUE(storage.saveGame(userId, tie, "Tie"));
+    EXPECT_EQ(storage.getPositionStats(tie).ties, 1);
+    EXPECT_EQ(storage.getPositionStats(corner).occurrences, 2);
+
+    char empty[3][3] = {
+        {' ', ' ', ' '},
+        {' ', ' ', ' '},
+        {' ', ' ', ' '}
+    };
+    EXPECT_EQ(storage.getPositionStats(empty).occurrences, 0);
+}
+
+TEST_F(DatabaseTest, PositionStats_AggregateAcrossGamesAndSymmetries) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+    expectPositionStatsAggregate(*db, userId);
+
+    QList<GameRecord> games = db->getGamesThisWeek(userId);
+    ASSERT_EQ(games.size(), 3);
+    EXPECT_EQ(games[0].moves, QVector<int>({0, 1, 3, 4, 6}));
+    EXPECT_TRUE(games[2].moves.isEmpty());
+}
+
+TEST_F(DatabaseTest, PositionStats_RebuildMatchesIncrementalCounts) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+    expectPositionStatsAggregate(*db, userId);
+    char corner[3][3] = {
+        {'X', ' ', ' '},
+        {' ', ' ', ' '},
+        {' ', ' ', ' '}
+    };
+    PositionStats before = db->getPositionStats(corner);
+    EXPECT_TRUE(db->rebuildPositionStats());
+    PositionStats after = db->getPositionStats(corner);
+    EXPECT_EQ(after.occurrences, before.occurrences);
+    EXPECT_EQ(after.xWins, before.xWins);
+    EXPECT_EQ(after.oWins, before.oWins);
+}
+
+TEST(MemoryStorageTest, PositionStatsMatchDatabase) {
+    MemoryStorage storage;
+    EXPECT_TRUE(storage.registerUser("testuser", "testpassword"));
+    expectPositionStatsAggregate(storage, storage.authenticate("testuser", "testpassword"));
+}
+
+// Test the read-through cache in front of history and stats
+TEST_F(DatabaseTest, ReadCache_ServesRepeatedReadsUntilSaveGame) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    EXPECT_TRUE(db->registerUser("otheruser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+    int otherId = db->authenticate("otheruser", "testpassword");
+    char board[3][3] = {
+        {'X', 'O', 'X'},
+        {'O', 'X', 'O'},
+        {'X', 'O', 'X'}
+    };
+    EXPECT_TRUE(db->saveGame(userId, board, "Win"));
+    db->readCache().resetCounters();
+
+    QString history = db->getGameHistory(userId);
+    EXPECT_EQ(db->getGameHistory(userId), history);
+    EXPECT_EQ(db->getUserStats(userId).wins, 1);
+    EXPECT_EQ(db->getUserStats(userId).wins, 1);
+    EXPECT_EQ(db->getUserStats(otherId).totalGames, 0);
+    EXPECT_EQ(db->readCache().hits(), 2);
+    EXPECT_EQ(db->readCache().misses(), 3);
+    EXPECT_GT(db->readCache().bytes(), 0);
+
+    // Saving for one user leaves other users' entries in place.
+    EXPECT_TRUE(db->saveGame(userId, board, "Loss"));
+    EXPECT_EQ(db->getGameHistory(userId).count("Game at"), 2);
+    EXPECT_EQ(db->getUserStats(userId).losses, 1);
+    EXPECT_EQ(db->getUserStats(otherId).totalGames, 0);
+    EXPECT_EQ(db->readCache().hits(), 3);
+    EXPECT_EQ(db->readCache().misses(), 5);
+    EXPECT_DOUBLE_EQ(db->readCache().hitRate(), 3.0 / 8.0);
+}
+
+TEST_F(DatabaseTest, ReadCache_ServesRepeatedRecentGamePages) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+    char board[3][3] = {{'X', 'X', 'X'}, {'O', 'O', ' '}, {' ', ' ', ' '}};
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(db->saveGame(userId, board, "X"));
+    }
+    db->readCache().resetCounters();
+
+    QList<GameRecord> first = db->getRecentGames(userId, 2);
+    ASSERT_EQ(first.size(), 2);
+    QList<GameRecord> second = db->getRecentGames(userId, 2, first.last().playedAt, first.last().id);
+    ASSERT_EQ(second.size(), 2);
+    EXPECT_EQ(db->readCache().misses(), 2);
+    EXPECT_EQ(db->readCache().hits(), 0);
+
+    EXPECT_EQ(db->getRecentGames(userId, 2).last().id, first.last().id);
+    EXPECT_EQ(db->getRecentGames(userId, 2, first.last().playedAt, first.last().id).first().id, second.first().id);
+    EXPECT_EQ(db->readCache().hits(), 2);
+    // A different page size or cursor is its own entry.
+    EXPECT_EQ(db->getRecentGames(userId, 3).size(), 3);
+    EXPECT_EQ(db->getRecentGames(userId, 2, second.last().playedAt, second.last().id).size(), 1);
+    EXPECT_EQ(db->readCache().misses(), 4);
+
+    // A new game invalidates every page of the user.
+    ASSERT_TRUE(db->saveGame(userId, board, "O"));
+    QList<GameRecord> refreshed = db->getRecentGames(userId, 2);
+    EXPECT_EQ(db->readCache().misses(), 5);
+    EXPECT_EQ(refreshed.first().result, "O");
+    EXPECT_EQ(db->getRecentGames(userId, 2, refreshed.last().playedAt, refreshed.last().id).size(), 2);
+    EXPECT_EQ(db->readCache().misses(), 6);
+}
+
+TEST(ReadCacheTest, StaysWithinByteBudget) {
+    ReadCache cache(16 * 1024);
+    const QString page(1000, 'x');
+    for (int userId = 1; userId <= 100; ++userId) {
+        cache.putHistory(userId, 0, page, 0);
+    }
+    EXPECT_LE(cache.bytes(), cache.maxBytes());
+
+    QString history;
+    EXPECT_TRUE(cache.history(100, 0, &history));
+    EXPECT_EQ(history, page);
+    EXPECT_FALSE(cache.history(1, 0, &history));
+
+    quint64 generation = 0;
+    EXPECT_FALSE(cache.history(99, 1, &history, &generation));
+    cache.invalidateUser(100);
+    EXPECT_FALSE(cache.history(100, 0, &history));
+    // A value read before an invalidation is not cached after it.
+    cache.putHistory(99, 1, page, generation);
+    EXPECT_FALSE(cache.history(99, 1, &history));
+    cache.setMaxBytes(0);
+    EXPECT_EQ(cache.bytes(), 0);
+}
+
+// Test per-thread connections
+TEST_F(DatabaseTest, ConnectionPool_WorkerThreadsShareOneDatabase) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+    char board[3][3] = {
+        {'X', 'O', 'X'},
+        {'O', 'X', 'O'},
+        {'X', 'O', 'X'}
+    };
+    const int threadCount = 4;
+    const int gamesPerThread = 25;
+    const int connectionsBefore = db->openConnections();
+    QAtomicInt failures;
+    QList<QThread *> threads;
+    for (int i = 0; i < threadCount; ++i) {
+        threads.append(QThread::create([&]() {
+            for (int game = 0; game < gamesPerThread; ++game) {
+                if (!db->saveGame(userId, board, "Win")) failures.ref();
+                if (db->authenticate("testuser", "testpassword") != userId) failures.ref();
+            }
+        }));
+    }
+    for (QThread *thread : threads) thread->start();
+    for (QThread *thread : threads) thread->wait();
+    qDeleteAll(threads);
+
+    EXPECT_EQ(failures.loadRelaxed(), 0);
+    EXPECT_EQ(db->getUserStats(userId).totalGames, threadCount * gamesPerThread);
+    // Each worker's connection is removed when its thread finishes.
+    EXPECT_EQ(db->openConnections(), connectionsBefore);
+}
+
+// Test salted password hashing and asynchronous authentication
+TEST(PasswordHasherTest, Pbkdf2MatchesReferenceVector) {
+    // RFC 7914, section 11.
+    QByteArray key = PasswordHasher::pbkdf2("passwd", "salt", 1, 64);
+    EXPECT_EQ(key.toHex(), QByteArray("55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc"
+                                      "49ca9cccf179b645991664b39d77ef317c71b845b1e30bd509112041d3a19783"));
+}
+
+TEST(PasswordHasherTest, HashesAreSaltedAndVerify) {
+    QString first = PasswordHasher::hash("testpassword", 1000);
+    QString second = PasswordHasher::hash("testpassword", 1000);
+    EXPECT_TRUE(first.startsWith("pbkdf2$sha256$1000$"));
+    EXPECT_NE(first, second);
+    EXPECT_TRUE(PasswordHasher::verify("testpassword", first));
+    EXPECT_TRUE(PasswordHasher::verify("testpassword", second));
+    EXPECT_FALSE(PasswordHasher::verify("wrongpassword", first));
+    EXPECT_FALSE(PasswordHasher::verify("testpassword", "pbkdf2$sha256$x$y"));
+    EXPECT_FALSE(PasswordHasher::needsRehash(first, 1000));
+    EXPECT_TRUE(PasswordHasher::needsRehash(first, 2000));
+}
+
+TEST(PasswordHasherTest, LegacyHashesVerifyAndNeedRehash) {
+    QString legacy = QCryptographicHash::hash("testpassword", QCryptographicHash::Sha256).toHex();
+    EXPECT_TRUE(PasswordHasher::verify("testpassword", legacy));
+    EXPECT_FALSE(PasswordHasher::verify("wrongpassword", legacy));
+    EXPECT_TRUE(PasswordHasher::needsRehash(legacy));
+    EXPECT_GE(PasswordHasher::calibrate(1), 1000);
+}
+
+TEST_F(DatabaseTest, Authenticate_RehashesLegacyPasswordOnLogin) {
+    QString path = QDir::temp().filePath(QString("tictactoe_rehash_%1.db").arg(QCoreApplication::applicationPid()));
+    QFile::remove(path);
+    {
+        Database fileDb(path);
+        QString stored;
+        {
+            QSqlDatabase raw = QSqlDatabase::addDatabase("QSQLITE", "legacy_writer");
+            raw.setDatabaseName(path);
+            ASSERT_TRUE(raw.open());
+            QSqlQuery query(raw);
+            query.prepare("INSERT INTO users (username, password) VALUES ('legacyuser', ?);");
+            query.addBindValue(QString(QCryptographicHash::hash("testpassword", QCryptographicHash::Sha256).toHex()));
+            ASSERT_TRUE(query.exec());
+
+            int userId = fileDb.authenticate("legacyuser", "testpassword");
+            EXPECT_GT(userId, 0);
+            EXPECT_EQ(fileDb.authenticate("legacyuser", "wrongpassword"), -1);
+            ASSERT_TRUE(query.exec("SELECT password FROM users WHERE username = 'legacyuser';") && query.next());
+            stored = query.value(0).toString();
+            query.finish();
+            EXPECT_EQ(fileDb.authenticate("legacyuser", "testpassword"), userId);
+            raw.close();
+        }
+        QSqlDatabase::removeDatabase("legacy_writer");
+        EXPECT_TRUE(stored.startsWith("pbkdf2$sha256$"));
+    }
+    QFile::remove(path);
+}
+
+TEST(DatabaseMigrationTest, BaselineFileIsConvertedOnOpen) {
+    QString path = QDir::temp().filePath(QString("tictactoe_baseline_%1.db").arg(QCoreApplication::applicationPid()));
+    QFile::remove(path);
+    // The win is stored with the lower id but was played later, so ratings only
+    // match when they are replayed in played_at order.
+    const QDateTime lossTime(QDate(2023, 3, 1), QTime(10, 0));
+    const QDateTime winTime(QDate(2023, 3, 2), QTime(18, 30));
+    {
+        QSqlDatabase raw = QSqlDatabase::addDatabase("QSQLITE", "baseline_writer");
+        raw.setDatabaseName(path);
+        ASSERT_TRUE(raw.open());
+        QSqlQuery query(raw);
+        ASSERT_TRUE(query.exec("CREATE TABLE users (id INTEGER PRIMARY KEY AUTOINCREMENT, username TEXT UNIQUE, password TEXT);"));
+        ASSERT_TRUE(query.exec("CREATE TABLE games (id INTEGER PRIMARY KEY AUTOINCREMENT, user_id INTEGER, board TEXT, result TEXT, timestamp TEXT);"));
+        query.prepare("INSERT INTO users (id, username, password) VALUES (1, 'veteran', ?);");
+        query.addBindValue(QString(QCryptographicHash::hash("password", QCryptographicHash::Sha256).toHex()));
+        ASSERT_TRUE(query.exec());
+        query.prepare("INSERT INTO games (user_id, board, result, timestamp) VALUES (1, ?, ?, ?);");
+        query.addBindValue(QString("XXXOO    "));
+        query.addBindValue(QString("X"));
+        query.addBindValue(winTime.toString());
+        ASSERT_TRUE(query.exec());
+        query.addBindValue(QString("OOOXX X  "));
+        query.addBindValue(QString("O"));
+        query.addBindValue(lossTime.toString());
+        ASSERT_TRUE(query.exec());
+        query.finish();
+        raw.close();
+    }
+    QSqlDatabase::removeDatabase("baseline_writer");
+
+    Database reference(":memory:");
+    char win[3][3] = {{'X', 'X', 'X'}, {'O', 'O', ' '}, {' ', ' ', ' '}};
+    char loss[3][3] = {{'O', 'O', 'O'}, {'X', 'X', ' '}, {'X', ' ', ' '}};
+    ASSERT_TRUE(reference.registerUser("veteran", "password"));
+    int referenceId = reference.authenticate("veteran", "password");
+    ASSERT_TRUE(reference.saveGame(referenceId, loss, "O"));
+    ASSERT_TRUE(reference.saveGame(referenceId, win, "X"));
+
+    {
+        Database fileDb(path);
+        EXPECT_EQ(fileDb.authenticate("veteran", "password"), 1);
+
+        QList<GameRecord> games = fileDb.getRecentGames(1, 10);
+        ASSERT_EQ(games.size(), 2);
+        EXPECT_EQ(games[0].board, "XXXOO    ");
+        EXPECT_EQ(games[0].playedAt, winTime);
+        EXPECT_EQ(games[1].board, "OOOXX X  ");
+        EXPECT_EQ(games[1].playedAt, lossTime);
+
+        UserStats stats = fileDb.getUserStats(1);
+        EXPECT_EQ(stats.totalGames, 2);
+        EXPECT_EQ(stats.wins, 1);
+        EXPECT_EQ(stats.losses, 1);
+        EXPECT_EQ(stats.pvpGames, 2);
+
+        EXPECT_DOUBLE_EQ(fileDb.getRating(1, Database::PvPRating),
+                         reference.getRating(referenceId, Database::PvPRating));
+        EXPECT_NE(fileDb.getRating(1, Database::PvPRating), 1200.0);
+        EXPECT_EQ(fileDb.getRank(1, Database::PvPRating), 1);
+    }
+    {
+        QSqlDatabase raw = QSqlDatabase::addDatabase("QSQLITE", "baseline_reader");
+        raw.setDatabaseName(path);
+        ASSERT_TRUE(raw.open());
+        QSqlQuery query(raw);
+        ASSERT_TRUE(query.exec("SELECT COUNT(*) FROM games WHERE played_at IS NULL OR played_at = 0"
+                               " OR board_code IS NULL;") && query.next());
+        EXPECT_EQ(query.value(0).toInt(), 0);
+        ASSERT_TRUE(query.exec("SELECT board_code FROM games ORDER BY id;") && query.next());
+        EXPECT_EQ(query.value(0).toInt(), BoardCodec::fromString("XXXOO    "));
+        query.finish();
+        raw.close();
+    }
+    QSqlDatabase::removeDatabase("baseline_reader");
+    QFile::remove(path);
+}
+
+TEST(AuthServiceTest, DeliversResultsBySignal) {
+    MemoryStorage storage;
+    AuthService auth(&storage);
+    QSignalSpy registered(&auth, &AuthService::registrationFinished);
+    QSignalSpy loggedIn(&auth, &AuthService::loginFinished);
+
+    auth.registerUser("testuser", "testpassword");
+    EXPECT_TRUE(auth.isBusy());
+    ASSERT_TRUE(registered.wait(5000));
+    EXPECT_EQ(registered.at(0).at(0).toString(), "testuser");
+    EXPECT_TRUE(registered.at(0).at(1).toBool());
+
+    auth.login("testuser", "testpassword");
+    auth.login("testuser", "wrongpassword");
+    while (loggedIn.size() < 2) {
+        ASSERT_TRUE(loggedIn.wait(5000));
+    }
+    QList<int> ids = {loggedIn.at(0).at(1).toInt(), loggedIn.at(1).at(1).toInt()};
+    std::sort(ids.begin(), ids.end());
+    EXPECT_EQ(ids[0], -1);
+    EXPECT_GT(ids[1], 0);
+    EXPECT_FALSE(auth.isBusy());
+}
+
+// Test streaming export and bulk import
+static void expectRoundTrip(Database &source, DataTransfer::Format format) {
+    QBuffer users;
+    QBuffer games;
+    users.open(QIODevice::WriteOnly);
+    games.open(QIODevice::WriteOnly);
+    DataTransfer exporter(&source);
+    DataTransfer::Result exportedUsers = exporter.exportUsers(&users, format);
+    DataTransfer::Result exportedGames = exporter.exportGames(&games, format);
+    EXPECT_TRUE(exportedUsers.ok);
+    EXPECT_TRUE(exportedGames.ok);
+    EXPECT_EQ(exportedUsers.rows, 2);
+    EXPECT_EQ(exportedGames.rows, 3);
+    users.close();
+    games.close();
+
+    Database target(":memory:");
+    DataTransfer importer(&target);
+    users.open(QIODevice::ReadOnly);
+    games.open(QIODevice::ReadOnly);
+    DataTransfer::Result importedUsers = importer.importUsers(&users, format);
+    DataTransfer::Result importedGames = importer.importGames(&games, format);
+    EXPECT_TRUE(importedUsers.ok);
+    EXPECT_TRUE(importedGames.ok);
+    EXPECT_EQ(importedUsers.rows, 2);
+    EXPECT_EQ(importedGames.rows, 3);
+    EXPECT_EQ(importedGames.skipped, 0);
+
+    int userId = target.authenticate("alice", "testpassword");
+    EXPECT_GT(userId, 0);
+    EXPECT_GT(target.authenticate("bob,\"the\" builder", "testpassword"), 0);
+    EXPECT_EQ(target.getGameHistory(userId), source.getGameHistory(userId));
+    UserStats stats = target.getUserStats(userId);
+    EXPECT_EQ(stats.totalGames, 2);
+    EXPECT_EQ(stats.aiWins, 1);
+    EXPECT_EQ(stats.bestStreak, 1);
+    EXPECT_DOUBLE_EQ(target.getRating(userId, Database::AIRating), source.getRating(userId, Database::AIRating));
+    QList<GameRecord> sourceGames = source.getGamesThisWeek(userId);
+    QList<GameRecord> targetGames = target.getGamesThisWeek(userId);
+    ASSERT_EQ(targetGames.size(), sourceGames.size());
+    EXPECT_EQ(targetGames[0].moves, sourceGames[0].moves);
+    EXPECT_EQ(targetGames[0].playedAt, sourceGames[0].playedAt);
+
+    // Importing the same rows again only skips them.
+    games.seek(0);
+    DataTransfer::Result again = importer.importGames(&games, format);
+    EXPECT_TRUE(again.ok);
+    EXPECT_EQ(again.rows, 0);
+    EXPECT_EQ(again.skipped, 3);
+    EXPECT_EQ(target.getUserStats(userId).totalGames, 2);
+}
+
+TEST_F(DatabaseTest, DataTransfer_RoundTripsJsonLinesAndCsv) {
+    EXPECT_TRUE(db->registerUser("alice", "testpassword"));
+    EXPECT_TRUE(db->registerUser("bob,\"the\" builder", "testpassword"));
+    int alice = db->authenticate("alice", "testpassword");
+    int bob = db->authenticate("bob,\"the\" builder", "testpassword");
+    char board[3][3] = {
+        {'X', 'O', ' '},
+        {'X', 'O', ' '},
+        {'X', ' ', ' '}
+    };
+    EXPECT_TRUE(db->saveGame(alice, board, "X", true, 'X', {0, 1, 3, 4, 6}));
+    EXPECT_TRUE(db->saveGame(alice, board, "Tie", false, 'X'));
+    EXPECT_TRUE(db->saveGame(bob, board, "O", false, 'O'));
+
+    expectRoundTrip(*db, DataTransfer::JsonLines);
+    expectRoundTrip(*db, DataTransfer::Csv);
+}
+
+TEST_F(DatabaseTest, DataTransfer_CsvKeepsLineBreaksInFields) {
+    const QString name = "multi\nline, \"quoted\"\r\nname";
+    ASSERT_TRUE(db->registerUser(name, "testpassword"));
+    ASSERT_TRUE(db->registerUser("after", "testpassword"));
+    QBuffer users;
+    users.open(QIODevice::WriteOnly);
+    ASSERT_TRUE(DataTransfer(db).exportUsers(&users, DataTransfer::Csv).ok);
+    users.close();
+
+    Database target(":memory:");
+    users.open(QIODevice::ReadOnly);
+    DataTransfer::Result imported = DataTransfer(&target).importUsers(&users, DataTransfer::Csv);
+    EXPECT_TRUE(imported.ok);
+    EXPECT_EQ(imported.rows, 2);
+    EXPECT_EQ(imported.skipped, 0);
+    EXPECT_EQ(target.authenticate(name, "testpassword"), db->authenticate(name, "testpassword"));
+    EXPECT_GT(target.authenticate("after", "testpassword"), 0);
+}
+
+TEST(DataTransferTest, CsvQuotingRoundTrips) {
+    QVariantList values = {qint64(7), QString("a,\"b\""), QString(), QVariant(), 1.5};
+    QByteArray line = DataTransfer::csvLine(values);
+    EXPECT_EQ(line, QByteArray("7,\"a,\"\"b\"\"\",\"\",,1.5"));
+    QList<QVariant> fields;
+    ASSERT_TRUE(DataTransfer::parseCsvLine(line, &fields));
+    ASSERT_EQ(fields.size(), 5);
+    EXPECT_EQ(fields[1].toString(), "a,\"b\"");
+    EXPECT_FALSE(fields[2].isNull());
+    EXPECT_TRUE(fields[2].toString().isEmpty());
+    EXPECT_TRUE(fields[3].isNull());
+    EXPECT_FALSE(DataTransfer::parseCsvLine("1,\"open", &fields));
+    EXPECT_EQ(DataTransfer::formatFor("games.CSV"), DataTransfer::Csv);
+    EXPECT_EQ(DataTransfer::formatFor("games.jsonl"), DataTransfer::JsonLines);
+}
+
+// Test retention rollups and incremental vacuum
+TEST_F(DatabaseTest, Retention_RollsUpOldGamesAndKeepsStats) {
+    EXPECT_TRUE(db->registerUser("testuser", "testpassword"));
+    EXPECT_TRUE(db->registerUser("otheruser", "testpassword"));
+    int userId = db->authenticate("testuser", "testpassword");
+    int otherId = db->authenticate("otheruser", "testpassword");
+    char board[3][3] = {
+        {'X', 'O', 'X'},
+        {'O', 'X', 'O'},
+        {'X', 'O', 'X'}
+    };
+    EXPECT_TRUE(db->saveGame(userId, board, "X", true, 'X'));
+    EXPECT_TRUE(db->saveGame(userId, board, "X", true, 'X'));
+    EXPECT_TRUE(db->saveGame(userId, board, "X", false, 'X'));
+    EXPECT_TRUE(db->saveGame(userId, board, "O", false, 'X'));
+    EXPECT_TRUE(db->saveGame(userId, board, "Tie", true, 'X'));
+    EXPECT_TRUE(db->saveGame(otherId, board, "Win"));
+    UserStats before = db->getUserStats(userId);
+
+    RetentionResult nothing = db->applyRetention(QDateTime::currentDateTimeUtc().addDays(-1), 2);
+    EXPECT_TRUE(nothing.ok);
+    EXPECT_EQ(nothing.archived, 0);
+
+    RetentionResult result = db->applyRetention(QDateTime::currentDateTimeUtc().addSecs(60), 2);
+    EXPECT_TRUE(result.ok);
+    EXPECT_EQ(result.archived, 6);
+    EXPECT_EQ(db->getGameHistory(userId), "No games played.");
+    EXPECT_EQ(db->getUserStats(userId).totalGames, before.totalGames);
+
+    EXPECT_TRUE(db->rebuildUserStats());
+    UserStats rebuilt = db->getUserStats(userId);
+    EXPECT_EQ(rebuilt.totalGames, before.totalGames);
+    EXPECT_EQ(rebuilt.aiWins, before.aiWins);
+    EXPECT_EQ(rebuilt.pvpLosses, before.pvpLosses);
+    EXPECT_EQ(rebuilt.ties, before.ties);
+    EXPECT_EQ(rebuilt.bestStreak, before.bestStreak);
+    EXPECT_EQ(db->getUserStats(otherId).wins, 1);
+
+    EXPECT_TRUE(db->saveGame(userId, board, "X", true, 'X'));
+    EXPECT_TRUE(db->rebuildUserStats());
+    EXPECT_EQ(db->getUserStats(userId).totalGames, before.totalGames + 1);
+}
+
+TEST_F(DatabaseTest, Retention_ReclaimsFreedPages) {
+    QString path = QDir::temp().filePath(QString("tictactoe_retention_%1.db").arg(QCoreApplication::applicationPid()));
+    QFile::remove(path);
+    {
+        Database fileDb(path);
+        QBuffer users;
+        users.setData("{\"id\":1,\"username\":\"old\",\"password\":\"x\",\"rating_pvp\":1200,\"rating_ai\":1200}\n");
+        users.open(QIODevice::ReadOnly);
+        QByteArray lines;
+        const qint64 longAgo = QDateTime::currentDateTimeUtc().addYears(-3).toMSecsSinceEpoch();
+        for (int i = 1; i <= 20000; ++i) {
+            lines += QString("{\"id\":%1,\"user_id\":1,\"board_code\":%2,\"result\":\"X\",\"played_at\":%3,"
+                             "\"vs_ai\":0,\"player_symbol\":\"X\",\"outcome\":0,\"moves\":0}\n")
+                         .arg(i).arg(i % BoardCodec::PositionCount).arg(longAgo + i).toUtf8();
+        }
+        QBuffer games(&lines);
+        games.open(QIODevice::ReadOnly);
+        DataTransfer transfer(&fileDb);
+        ASSERT_TRUE(transfer.importUsers(&users, DataTransfer::JsonLines).ok);
+        ASSERT_EQ(transfer.importGames(&games, DataTransfer::JsonLines).rows, 20000);
+
+        RetentionResult result = fileDb.applyRetention(QDateTime::currentDateTimeUtc().addYears(-1));
+        EXPECT_TRUE(result.ok);
+        EXPECT_EQ(result.archived, 20000);
+        EXPECT_GT(result.reclaimedPages, 0);
+        EXPECT_EQ(fileDb.getUserStats(1).totalGames, 20000);
+    }
+    QFile::remove(path);
+}
+
+TEST(DatabaseFileTest, NewFileUsesIncrementalVacuum) {
+    QString path = QDir::temp().filePath(QString("tictactoe_vacuum_%1.db").arg(QCoreApplication::applicationPid()));
+    QFile::remove(path);
+    {
+        Database fileDb(path);
+        ASSERT_TRUE(fileDb.registerUser("vacuum", "password"));
+    }
+    {
+        QSqlDatabase raw = QSqlDatabase::addDatabase("QSQLITE", "vacuum_reader");
+        raw.setDatabaseName(path);
+        ASSERT_TRUE(raw.open());
+        QSqlQuery query(raw);
+        ASSERT_TRUE(query.exec("PRAGMA auto_vacuum;") && query.next());
+        EXPECT_EQ(query.value(0).toInt(), 2);
+        ASSERT_TRUE(query.exec("PRAGMA journal_mode;") && query.next());
+        EXPECT_EQ(query.value(0).toString(), "wal");
+        query.finish();
+        raw.close();
+    }
+    QSqlDatabase::removeDatabase("vacuum_reader");
+    QFile::remove(path);
+}
+
+TEST_F(DatabaseTest, Backup_CopiesUsersAndGames) {
+    QString path = QDir::temp().filePath(QString("tictactoe_backup_%1.db").arg(QCoreApplication::applicationPid()));
+    ASSERT_TRUE(db->registerUser("saved", "password"));
+    int userId = db->authenticate("saved", "password");
+    char board[3][3] = {{'X', 'X', 'X'}, {'O', 'O', ' '}, {' ', ' ', ' '}};
+    ASSERT_TRUE(db->saveGame(userId, board, "X"));
+
+    ASSERT_TRUE(db->backupInBackground(path).result());
+    {
+        Database copy(path);
+        EXPECT_EQ(copy.authenticate("saved", "password"), userId);
+        EXPECT_EQ(copy.getUserStats(userId).totalGames, 1);
+    }
+    QFile::remove(path);
+}
+
+TEST(DatabaseFileTest, Backup_RefusesLiveFileAndSnapshot) {
+    QString path = QDir::temp().filePath(QString("tictactoe_live_%1.db").arg(QCoreApplication::applicationPid()));
+    QString snapshotPath = path + ".snapshot";
+    QFile::remove(path);
+    {
+        Database fileDb(path);
+        ASSERT_TRUE(fileDb.registerUser("kept", "password"));
+        ASSERT_TRUE(fileDb.enableSnapshot(snapshotPath));
+        EXPECT_FALSE(fileDb.backupTo(path));
+        EXPECT_FALSE(fileDb.backupTo(snapshotPath));
+        EXPECT_GT(fileDb.authenticate("kept", "password"), 0);
+        EXPECT_EQ(fileDb.getLeaderboard(Database::PvPRating, 10).size(), 1);
+    }
+    {
+        Database reopened(path);
+        EXPECT_GT(reopened.authenticate("kept", "password"), 0);
+    }
+    QFile::remove(path);
+    QFile::remove(snapshotPath);
+}
+
+TEST_F(DatabaseTest, Snapshot_ServesLeaderboardUntilRefreshed) {
+    QString path = QDir::temp().filePath(QString("tictactoe_snapshot_%1.db").arg(QCoreApplication::applicationPid()));
+    ASSERT_TRUE(db->registerUser("first", "password"));
+    ASSERT_TRUE(db->enableSnapshot(path));
+    EXPECT_TRUE(db->snapshotEnabled());
+    EXPECT_EQ(db->getLeaderboard(Database::PvPRating, 10).size(), 1);
+
+    ASSERT_TRUE(db->registerUser("second", "password"));
+    EXPECT_EQ(db->getLeaderboard(Database::PvPRating, 10).size(), 1);
+    // Not in the snapshot yet, so it has no rank rather than rank 1.
+    EXPECT_EQ(db->getRank(db->authenticate("second", "password"), Database::PvPRating), -1);
+
+    ASSERT_TRUE(db->refreshSnapshot());
+    EXPECT_EQ(db->getLeaderboard(Database::PvPRating, 10).size(), 2);
+    EXPECT_GT(db->getRank(db->authenticate("second", "password"), Database::PvPRating), 0);
+    delete db;
+    db = nullptr;
+    QFile::remove(path);
+}
+
+TEST_F(DatabaseTest, SnapshotJob_TakesFirstSnapshotInBackground) {
+    QString path = QDir::temp().filePath(QString("tictactoe_snapshotjob_%1.db").arg(QCoreApplication::applicationPid()));
+    ASSERT_TRUE(db->registerUser("first", "password"));
+    {
+        SnapshotJob job(db, path);
+        QSignalSpy refreshed(&job, &SnapshotJob::refreshed);
+        ASSERT_TRUE(refreshed.wait(5000));
+        EXPECT_TRUE(refreshed.at(0).at(0).toBool());
+        EXPECT_TRUE(job.isEnabled());
+        EXPECT_TRUE(db->snapshotEnabled());
+        EXPECT_EQ(db->getLeaderboard(Database::PvPRating, 10).size(), 1);
+    }
+    delete db;
+    db = nullptr;
+    QFile::remove(path);
+}
+
+TEST_F(DatabaseTest, Reshard_KeepsGamesStatsAndRanks) {
+    char win[3][3] = {{'X', 'X', 'X'}, {'O', 'O', ' '}, {' ', ' ', ' '}};
+    char tie[3][3] = {{'X', 'O', 'X'}, {'X', 'O', 'O'}, {'O', 'X', 'X'}};
+    QList<int> userIds;
+    for (int i = 0; i < 12; ++i) {
+        QString name = QString("player%1").arg(i);
+        ASSERT_TRUE(db->registerUser(name, "password"));
+        userIds.append(db->authenticate(name, "password"));
+        for (int game = 0; game < i; ++game) {
+            ASSERT_TRUE(db->saveGame(userIds.last(), game % 2 ? tie : win, game % 2 ? "Tie" : "X", game % 3 == 0));
+        }
+    }
+    auto snapshot = [&]() {
+        QStringList state;
+        for (int userId : userIds) {
+            UserStats stats = db->getUserStats(userId);
+            state << QString("%1 %2 %3 %4 %5 %6").arg(userId).arg(stats.totalGames).arg(stats.wins)
+                         .arg(stats.bestStreak).arg(db->getRank(userId, Database::PvPRating))
+                         .arg(db->getRating(userId, Database::AIRating));
+        }
+        for (const RatingEntry &entry : db->getLeaderboard(Database::PvPRating, 5)) {
+            state << QString("top %1 %2").arg(entry.userId).arg(entry.rating);
+        }
+        state << QString::number(db->getPositionStats(win).occurrences);
+        return state;
+    };
+    const QStringList before = snapshot();
+
+    ASSERT_TRUE(db->reshard(4));
+    EXPECT_EQ(db->shardCount(), 4);
+    EXPECT_EQ(snapshot(), before);
+
+    // New users and games land in their shard.
+    ASSERT_TRUE(db->registerUser("newcomer", "password"));
+    int newcomer = db->authenticate("newcomer", "password");
+    ASSERT_TRUE(db->saveGame(newcomer, win, "X"));
+    EXPECT_EQ(db->getUserStats(newcomer).totalGames, 1);
+    EXPECT_GT(db->getRank(newcomer, Database::PvPRating), 0);
+    userIds.append(newcomer);
+    const QStringList sharded = snapshot();
+
+    ASSERT_TRUE(db->reshard(1));
+    EXPECT_EQ(db->shardCount(), 1);
+    EXPECT_EQ(snapshot(), sharded);
+}
+
+TEST_F(DatabaseTest, DataTransfer_RefusesShardedUserExport) {
+    ASSERT_TRUE(db->registerUser("sharded", "password"));
+    int userId = db->authenticate("sharded", "password");
+    ASSERT_TRUE(db->reshard(2));
+    char win[3][3] = {{'X', 'X', 'X'}, {'O', 'O', ' '}, {' ', ' ', ' '}};
+    ASSERT_TRUE(db->saveGame(userId, win, "X"));
+    ASSERT_GT(db->getRating(userId, Database::PvPRating), 1200.0);
+
+    // The main file still holds the rating from before the game.
+    QBuffer users;
+    users.open(QIODevice::WriteOnly);
+    DataTransfer transfer(db);
+    EXPECT_FALSE(transfer.exportUsers(&users, DataTransfer::JsonLines).ok);
+    EXPECT_TRUE(users.data().isEmpty());
+
+    ASSERT_TRUE(db->reshard(1));
+    users.close();
+    users.setData(QByteArray());
+    users.open(QIODevice::WriteOnly);
+    ASSERT_TRUE(transfer.exportUsers(&users, DataTransfer::JsonLines).ok);
+    QJsonObject row = QJsonDocument::fromJson(users.data().trimmed()).object();
+    EXPECT_DOUBLE_EQ(row.value("rating_pvp").toDouble(), db->getRating(userId, Database::PvPRating));
+}
+
+TEST_F(DatabaseTest, DataTransfer_RefusesShardedImports) {
+    ASSERT_TRUE(db->reshard(2));
+    QBuffer users;
+    users.setData("{\"id\":7,\"username\":\"imported\",\"password\":\"x\",\"rating_pvp\":1200,\"rating_ai\":1200}\n");
+    users.open(QIODevice::ReadOnly);
+    DataTransfer transfer(db);
+    EXPECT_FALSE(transfer.importUsers(&users, DataTransfer::JsonLines).ok);
+    EXPECT_EQ(db->getRank(7, Database::PvPRating), -1);
+}
+
+TEST(DatabaseShardTest, LayoutSurvivesReopen) {
+    QString path = QDir::temp().filePath(QString("tictactoe_shards_%1.db").arg(QCoreApplication::applicationPid()));
+    char board[3][3] = {{'X', 'X', 'X'}, {'O', 'O', ' '}, {' ', ' ', ' '}};
+    int userId = -1;
+    {
+        Database fileDb(path);
+        ASSERT_TRUE(fileDb.registerUser("sharded", "password"));
+        userId = fileDb.authenticate("sharded", "password");
+        ASSERT_TRUE(fileDb.saveGame(userId, board, "X"));
+        ASSERT_TRUE(fileDb.reshard(3));
+        EXPECT_TRUE(QFile::exists(path + ".shard-1-of-3"));
+    }
+    {
+        Database fileDb(path);
+        EXPECT_EQ(fileDb.shardCount(), 3);
+        EXPECT_EQ(fileDb.getUserStats(userId).totalGames, 1);
+        ASSERT_TRUE(fileDb.reshard(1));
+    }
+    EXPECT_FALSE(QFile::exists(path + ".shard-1-of-3"));
+    {
+        Database fileDb(path);
+        EXPECT_EQ(fileDb.shardCount(), 1);
+        EXPECT_EQ(fileDb.getUserStats(userId).totalGames, 1);
+    }
+    QFile::remove(path);
+}
+
 // Main function to run tests
 int main(int argc, char **argv) {
     // Initialize Qt Application (required for Qt SQL operations)
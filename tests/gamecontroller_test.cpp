@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QSignalSpy>
+#include <QTest>
+#include <QtConcurrent/QtConcurrent>
+#include <iostream>
+#include "GameController.h"
+#include "MemoryStorage.h"
+
+namespace {
+
+int countMarks(const GameController &controller) {
+    char board[3][3];
+    controller.getBoard(board);
+    int marks = 0;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            marks += board[i][j] != ' ' ? 1 : 0;
+        }
+    }
+    return marks;
+}
+
+// Plays random legal moves for the human side until `games` games end;
+// returns how many the human won.
+int playRandomGames(GameController &controller, int games, quint32 seed) {
+    QRandomGenerator random(seed);
+    int finished = 0;
+    int humanWins = 0;
+    QObject scope;
+    QObject::connect(&controller, &GameController::gameOver, &scope, [&](char winner) {
+        ++finished;
+        humanWins += winner == controller.playerSymbol() ? 1 : 0;
+    });
+    while (finished < games) {
+        const int cell = random.bounded(9);
+        controller.playMove(cell / 3, cell % 3);
+    }
+    return humanWins;
+}
+
+}
+
+TEST(GameControllerTest, PlayerVsPlayerWinIsSavedAndStartsANewRound) {
+    MemoryStorage storage;
+    storage.registerUser("player", "password");
+    const int userId = storage.authenticate("player", "password");
+    GameController controller(&storage, userId);
+    QSignalSpy moves(&controller, &GameController::moveApplied);
+    QSignalSpy over(&controller, &GameController::gameOver);
+    QSignalSpy saved(&controller, &GameController::resultSaved);
+
+    EXPECT_FALSE(controller.playMove(0, 0));
+    controller.startGame(false);
+    for (int cell : {0, 3, 1, 4}) {
+        ASSERT_TRUE(controller.playMove(cell / 3, cell % 3));
+    }
+    EXPECT_EQ(controller.currentPlayer(), 'X');
+    EXPECT_FALSE(controller.playMove(0, 0));
+    ASSERT_TRUE(controller.playMove(0, 2));
+
+    EXPECT_EQ(moves.size(), 5);
+    ASSERT_EQ(over.size(), 1);
+    EXPECT_EQ(over[0][0].value<char>(), 'X');
+    EXPECT_EQ(over[0][1].toString(), "X");
+    EXPECT_EQ(saved.size(), 1);
+    EXPECT_EQ(storage.getUserStats(userId).totalGames, 1);
+    EXPECT_EQ(countMarks(controller), 0);
+    EXPECT_EQ(controller.currentPlayer(), 'X');
+}
+
+TEST(GameControllerTest, AIRepliesAndNeverLoses) {
+    MemoryStorage storage;
+    GameController controller(&storage);
+    controller.startGame(true, 'O');
+    QSignalSpy thinking(&controller, &GameController::aiThinking);
+    ASSERT_TRUE(controller.playMove(1, 1));
+    EXPECT_EQ(countMarks(controller), 2);
+    ASSERT_EQ(thinking.size(), 2);
+    EXPECT_FALSE(thinking[1][0].toBool());
+    EXPECT_EQ(controller.currentPlayer(), 'O');
+
+    QElapsedTimer clock;
+    clock.start();
+    EXPECT_EQ(playRandomGames(controller, 200, 7), 0);
+    std::cout << "200 headless games against the AI in " << clock.elapsed() << " ms" << std::endl;
+}
+
+TEST(GameControllerTest, AsyncAIRepliesOnAWorker) {
+    MemoryStorage storage;
+    GameController controller(&storage);
+    controller.setAsyncAI(true);
+    controller.startGame(true);
+    QSignalSpy thinking(&controller, &GameController::aiThinking);
+    ASSERT_TRUE(controller.playMove(0, 0));
+    EXPECT_TRUE(controller.isAIThinking());
+    EXPECT_FALSE(controller.playMove(2, 2));
+    ASSERT_TRUE(thinking.wait(5000));
+    EXPECT_FALSE(controller.isAIThinking());
+    EXPECT_EQ(countMarks(controller), 2);
+    EXPECT_EQ(controller.currentPlayer(), 'X');
+}
+
+TEST(GameControllerTest, RestartDiscardsAnAIReplyInFlight) {
+    MemoryStorage storage;
+    GameController controller(&storage);
+    controller.setAsyncAI(true);
+    controller.startGame(true);
+    QSignalSpy moves(&controller, &GameController::moveApplied);
+    ASSERT_TRUE(controller.playMove(0, 0));
+    controller.restart();
+    QTest::qWait(200);
+    EXPECT_EQ(moves.size(), 1);
+    EXPECT_EQ(countMarks(controller), 0);
+    EXPECT_TRUE(controller.playMove(1, 1));
+}
+
+TEST(GameControllerTest, GamesRunConcurrentlyOnOneStorage) {
+    MemoryStorage storage;
+    QList<int> users;
+    for (int i = 0; i < 4; ++i) {
+        const QString name = QString("player%1").arg(i);
+        storage.registerUser(name, "password");
+        users.append(storage.authenticate(name, "password"));
+    }
+    QtConcurrent::blockingMap(users, [&storage](int userId) {
+        GameController controller(&storage, userId);
+        controller.startGame(true);
+        playRandomGames(controller, 50, userId);
+    });
+    for (int userId : users) {
+        const UserStats stats = storage.getUserStats(userId);
+        EXPECT_EQ(stats.totalGames, 50);
+        EXPECT_EQ(stats.wins, 0);
+    }
+}
+
+int main(int argc, char **argv) {
+    QApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
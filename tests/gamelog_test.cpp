@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+#include <QElapsedTimer>
+#include <iostream>
+#include "GameLog.h"
+
+class GameLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(dir.isValid());
+    }
+
+    static GameLogRecord record(quint32 userId, qint64 timestamp) {
+        return GameLog::makeRecord(userId, {4, 0, 8, 2, 6}, 0, true, 'X', timestamp);
+    }
+
+    QTemporaryDir dir;
+};
+
+TEST_F(GameLogTest, MakeRecord_PacksAndUnpacksMoves) {
+    GameLogRecord r = GameLog::makeRecord(7, {4, 0, 8, 2, 6, 1, 3, 5, 7}, 2, true, 'O', 123);
+    EXPECT_EQ(r.userId, 7u);
+    EXPECT_EQ(r.moveCount, 9);
+    EXPECT_EQ(r.outcome, 2);
+    EXPECT_EQ(r.flags, GameLog::VsAIFlag | GameLog::SymbolOFlag);
+    EXPECT_EQ(GameLog::unpackMoves(r), QVector<int>({4, 0, 8, 2, 6, 1, 3, 5, 7}));
+}
+
+TEST_F(GameLogTest, Append_ScansBackInOrder) {
+    GameLog log(dir.path(), 16);
+    ASSERT_TRUE(log.isOpen());
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(log.append(record(i % 3, i)));
+    }
+    EXPECT_EQ(log.size(), 10);
+
+    qint64 expected = 0;
+    log.scan([&](const GameLogRecord &r) {
+        EXPECT_EQ(r.timestamp, expected);
+        EXPECT_TRUE(GameLog::isValid(r));
+        ++expected;
+    });
+    EXPECT_EQ(expected, 10);
+}
+
+TEST_F(GameLogTest, Reopen_KeepsRecordsAndContinuesAppending) {
+    {
+        GameLog log(dir.path(), 16);
+        for (int i = 0; i < 5; ++i) {
+            log.append(record(1, i));
+        }
+    }
+    GameLog log(dir.path(), 16);
+    EXPECT_EQ(log.size(), 5);
+    EXPECT_TRUE(log.append(record(1, 5)));
+    EXPECT_EQ(log.recordsForUser(1).size(), 6);
+}
+
+TEST_F(GameLogTest, Open_TruncatesTornTail) {
+    {
+        GameLog log(dir.path(), 16);
+        for (int i = 0; i < 5; ++i) {
+            log.append(record(1, i));
+        }
+    }
+    // Simulate a crash in the middle of writing record 3.
+    QFile segment(QDir(dir.path()).filePath("segment-00000000.log"));
+    ASSERT_TRUE(segment.open(QIODevice::ReadWrite));
+    ASSERT_TRUE(segment.seek(3 * sizeof(GameLogRecord) + 10));
+    segment.write("garbage", 7);
+    segment.close();
+
+    GameLog log(dir.path(), 16);
+    EXPECT_EQ(log.size(), 3);
+    EXPECT_TRUE(log.append(record(1, 99)));
+    EXPECT_EQ(log.size(), 4);
+    QVector<GameLogRecord> records = log.recordsForUser(1);
+    ASSERT_EQ(records.size(), 4);
+    EXPECT_EQ(records.last().timestamp, 99);
+}
+
+TEST_F(GameLogTest, Compaction_IndexesSealedSegments) {
+    {
+        GameLog log(dir.path(), 4);
+        for (int i = 0; i < 10; ++i) {
+            log.append(record(i % 2, i));
+        }
+        EXPECT_EQ(log.segmentCount(), 3);
+        log.compactInBackground().waitForFinished();
+        EXPECT_TRUE(QFile::exists(QDir(dir.path()).filePath("segment-00000000.idx")));
+        EXPECT_TRUE(QFile::exists(QDir(dir.path()).filePath("segment-00000001.idx")));
+        EXPECT_FALSE(QFile::exists(QDir(dir.path()).filePath("segment-00000002.idx")));
+
+        QVector<GameLogRecord> odd = log.recordsForUser(1);
+        ASSERT_EQ(odd.size(), 5);
+        for (int i = 0; i < odd.size(); ++i) {
+            EXPECT_EQ(odd[i].timestamp, 2 * i + 1);
+        }
+    }
+    GameLog log(dir.path(), 4);
+    EXPECT_EQ(log.size(), 10);
+    EXPECT_EQ(log.recordsForUser(0).size(), 5);
+}
+
+TEST_F(GameLogTest, AppendThroughput) {
+    // Reports the single-thread append rate; printed only, since wall-clock
+    // thresholds are too noisy to assert on.
+    const qint64 records = 1 << 20;
+    GameLog log(dir.path(), 1 << 18);
+    ASSERT_TRUE(log.isOpen());
+    const GameLogRecord prepared = record(1, 0);
+    QElapsedTimer clock;
+    clock.start();
+    for (qint64 i = 0; i < records; ++i) {
+        ASSERT_TRUE(log.append(prepared));
+    }
+    const qint64 nanos = qMax<qint64>(1, clock.nsecsElapsed());
+    EXPECT_EQ(log.size(), records);
+    EXPECT_EQ(log.segmentCount(), 4);
+    std::cout << "GameLog append: " << records << " records in " << nanos / 1000000 << " ms, "
+              << qRound64(records * 1e9 / nanos) << " records/s" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <QApplication>
+#include <QImage>
+#include <QPainter>
+#include <QSet>
+#include <QSignalSpy>
+#include <QStyleOptionViewItem>
+#include "HistoryDelegate.h"
+#include "HistoryModel.h"
+#include "MemoryStorage.h"
+
+namespace {
+
+int addGames(MemoryStorage &storage, int count) {
+    storage.registerUser("player", "password");
+    int userId = storage.authenticate("player", "password");
+    char board[3][3] = {
+        {'X', 'O', 'X'},
+        {' ', 'X', 'O'},
+        {' ', ' ', 'X'}
+    };
+    for (int i = 0; i < count; ++i) {
+        board[2][0] = i % 2 ? 'O' : ' ';
+        storage.saveGame(userId, board, i % 3 ? "Win" : "Draw");
+    }
+    return userId;
+}
+
+bool waitForPage(HistoryModel &model) {
+    QSignalSpy spy(&model, &HistoryModel::pageLoaded);
+    return spy.wait(5000);
+}
+
+}
+
+TEST(HistoryModelTest, LoadsEveryGamePageByPage) {
+    MemoryStorage storage;
+    int userId = addGames(storage, 1050);
+    HistoryModel model(&storage, userId, 100);
+    EXPECT_EQ(model.rowCount(), 0);
+    EXPECT_TRUE(model.canFetchMore(QModelIndex()));
+
+    int pages = 0;
+    while (model.canFetchMore(QModelIndex())) {
+        model.fetchMore(QModelIndex());
+        // A second request while one is in flight is ignored.
+        model.fetchMore(QModelIndex());
+        ASSERT_TRUE(waitForPage(model));
+        ++pages;
+    }
+    EXPECT_EQ(pages, 11);
+    ASSERT_EQ(model.rowCount(), 1050);
+
+    QSet<qint64> ids;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        ids.insert(model.game(row).id);
+        if (row > 0) {
+            EXPECT_LT(model.game(row).id, model.game(row - 1).id);
+        }
+    }
+    EXPECT_EQ(ids.size(), 1050);
+    EXPECT_EQ(model.data(model.index(0), HistoryModel::ResultRole).toString(), model.game(0).result);
+    EXPECT_FALSE(model.data(model.index(1050), HistoryModel::ResultRole).isValid());
+}
+
+TEST(HistoryModelTest, EmptyHistoryStopsAfterOnePage) {
+    MemoryStorage storage;
+    HistoryModel model(&storage, 42);
+    model.fetchMore(QModelIndex());
+    ASSERT_TRUE(waitForPage(model));
+    EXPECT_EQ(model.rowCount(), 0);
+    EXPECT_FALSE(model.canFetchMore(QModelIndex()));
+}
+
+TEST(HistoryDelegateTest, FixedRowsAndCachedThumbnails) {
+    MemoryStorage storage;
+    int userId = addGames(storage, 50);
+    HistoryModel model(&storage, userId);
+    model.fetchMore(QModelIndex());
+    ASSERT_TRUE(waitForPage(model));
+
+    HistoryDelegate delegate;
+    QImage image(300, HistoryDelegate::RowHeight, QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+    QStyleOptionViewItem option;
+    option.rect = image.rect();
+    for (int row = 0; row < model.rowCount(); ++row) {
+        EXPECT_EQ(delegate.sizeHint(option, model.index(row)).height(), HistoryDelegate::RowHeight);
+        delegate.paint(&painter, option, model.index(row));
+    }
+    // The games end on two different boards.
+    EXPECT_EQ(delegate.cachedThumbnails(), 2);
+}
+
+int main(int argc, char **argv) {
+    QApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
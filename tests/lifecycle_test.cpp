@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <QApplication>
+#include <QFile>
+#include <QPointer>
+#include <QPushButton>
+#include <QSignalSpy>
+#include <iostream>
+#include "AuthWindow.h"
+#include "MainWindow.h"
+#include "MemoryStorage.h"
+#include "StorageService.h"
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Resident set size in bytes, or -1 where it cannot be read.
+qint64 residentBytes() {
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+#endif
+    return -1;
+}
+
+void logInAndOut(AuthWindow &authWindow, int userId) {
+    MainWindow *gameWindow = authWindow.openGameWindow(userId);
+    gameWindow->findChild<QPushButton *>("logoutButton")->click();
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+}
+
+}
+
+TEST(StorageServiceTest, OpensDatabaseInBackground) {
+    StorageService service(":memory:");
+    QSignalSpy ready(&service, &StorageService::ready);
+    if (!service.isReady()) {
+        ASSERT_TRUE(ready.wait(5000));
+    }
+    ASSERT_NE(service.storage(), nullptr);
+    EXPECT_TRUE(service.storage()->registerUser("player", "password"));
+
+    AuthWindow authWindow(&service);
+    EXPECT_TRUE(authWindow.isStorageReady());
+}
+
+TEST(StorageServiceTest, LogoutReturnsToTheSameLoginWindow) {
+    StorageService service(new MemoryStorage());
+    AuthWindow authWindow(&service);
+    ASSERT_TRUE(authWindow.isStorageReady());
+    authWindow.show();
+
+    MainWindow *gameWindow = authWindow.openGameWindow(-1);
+    EXPECT_FALSE(authWindow.isVisible());
+    QPointer<MainWindow> watched(gameWindow);
+    gameWindow->findChild<QPushButton *>("logoutButton")->click();
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    EXPECT_TRUE(watched.isNull());
+    EXPECT_TRUE(authWindow.isVisible());
+}
+
+TEST(StorageServiceTest, MemoryStaysFlatOverLoginCycles) {
+    StorageService service(":memory:");
+    service.waitForReady();
+    Database *database = static_cast<Database *>(service.storage());
+    ASSERT_TRUE(database->registerUser("player", "password"));
+    const int userId = database->authenticate("player", "password");
+    AuthWindow authWindow(&service);
+    authWindow.show();
+
+    // Warm up caches, fonts and style data that are allocated once.
+    for (int i = 0; i < 500; ++i) {
+        logInAndOut(authWindow, userId);
+    }
+    const int windows = QApplication::topLevelWidgets().size();
+    const int connections = database->openConnections();
+    const qint64 before = residentBytes();
+
+    for (int i = 0; i < 10000; ++i) {
+        logInAndOut(authWindow, i % 2 ? userId : -1);
+    }
+    const qint64 after = residentBytes();
+    std::cout << "Resident memory over 10000 cycles: " << before / 1024 << " KiB -> "
+              << after / 1024 << " KiB" << std::endl;
+
+    EXPECT_EQ(QApplication::topLevelWidgets().size(), windows);
+    EXPECT_EQ(database->openConnections(), connections);
+    EXPECT_EQ(service.storage(), database);
+    if (before > 0) {
+        // A leaked game window is well over 10 KiB, so 10000 of them would
+        // add about 100 MiB; allow a little allocator noise.
+        EXPECT_LT(after - before, 8 * 1024 * 1024);
+    }
+}
+
+int main(int argc, char **argv) {
+    // Game windows skip their mode dialogs and the logout confirmation.
+    qputenv("TICTACTOE_TEST_MODE", "1");
+    QApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
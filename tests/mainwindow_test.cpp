@@ -17,6 +17,11 @@
 #include "MainWindow.h"
 #include "Database.h"
 #include "Game.h"
+#include "BoardView.h"
+#include "PerfHud.h"
+#include <QElapsedTimer>
+#include <QImage>
+#include <iostream>
 
 // Helper function to convert QString to std::string for Google Test
 std::string qStringToStdString(const QString& qstr) {
@@ -83,18 +88,9 @@ protected:
         return nullptr;
     }
 
-    // Helper to get game board cells
-    QList<QPushButton*> getGameBoardCells() {
-        auto buttons = mainWindow->findChildren<QPushButton*>();
-        QList<QPushButton*> cells;
-        for (auto* button : buttons) {
-            QString objectName = button->objectName();
-            // Game cells have object names like "cell_0_0", "cell_0_1", etc.
-            if (objectName.startsWith("cell_")) {
-                cells.append(button);
-            }
-        }
-        return cells;
+    // Helper to get the painted game board
+    BoardView* getGameBoard() {
+        return mainWindow->findChild<BoardView*>();
     }
 
     std::unique_ptr<QApplication> app;
@@ -196,46 +192,55 @@ TEST_F(MainWindowTest, ModeIndicatorExists) {
 // ============= GAME BOARD TESTS =============
 TEST_F(MainWindowTest, GameBoardHasExactly9Cells) {
     createMainWindow(1);
-    auto gameCells = getGameBoardCells();
-    EXPECT_EQ(gameCells.size(), 9) << "Game board should have exactly 9 cells";
+    BoardView* board = getGameBoard();
+    ASSERT_NE(board, nullptr) << "Game board should exist";
+    EXPECT_EQ(board->boardSize() * board->boardSize(), 9) << "Game board should have exactly 9 cells";
 }
 
 TEST_F(MainWindowTest, GameBoardCellsAreInitiallyEmpty) {
     createMainWindow(1);
-    auto gameCells = getGameBoardCells();
-    for (auto* cell : gameCells) {
-        QString text = cell->text().trimmed();
-        EXPECT_TRUE(text.isEmpty() || text == " ")
-            << "Game cells should be initially empty";
+    BoardView* board = getGameBoard();
+    ASSERT_NE(board, nullptr);
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col) {
+            EXPECT_EQ(board->mark(row, col), ' ') << "Game cells should be initially empty";
+        }
     }
 }
 
 TEST_F(MainWindowTest, GameBoardCellsAreInitiallyDisabled) {
     createMainWindow(1);
-    auto gameCells = getGameBoardCells();
+    BoardView* board = getGameBoard();
+    ASSERT_NE(board, nullptr);
     // In test mode, cells should be enabled since game is auto-started
-    for (auto* cell : gameCells) {
-        EXPECT_TRUE(cell->isEnabled())
-            << "Game cells should be enabled in test mode";
-    }
+    EXPECT_TRUE(board->cellsEnabled()) << "Game cells should be enabled in test mode";
 }
 
-TEST_F(MainWindowTest, GameBoardHasGridLayout) {
+TEST_F(MainWindowTest, GameBoardIsOnePaintedWidget) {
     createMainWindow(1);
-    // Look for a grid layout in the UI hierarchy
-    bool hasGridLayout = false;
-    std::function<void(QObject*)> checkForGridLayout = [&](QObject* obj) {
-        if (auto* layout = qobject_cast<QGridLayout*>(obj)) {
-            hasGridLayout = true;
-            return;
-        }
-        
-        for (auto* child : obj->children()) {
-            checkForGridLayout(child);
+    ASSERT_NE(getGameBoard(), nullptr);
+    for (auto* button : mainWindow->findChildren<QPushButton*>()) {
+        EXPECT_FALSE(button->objectName().startsWith("cell_")) << "Cells are painted, not buttons";
+    }
+}
+
+TEST_F(MainWindowTest, ClickingACellPlaysAMove) {
+    createMainWindow(-1);
+    mainWindow->show();
+    QApplication::processEvents();
+    BoardView* board = getGameBoard();
+    ASSERT_NE(board, nullptr);
+    QTest::mouseClick(board, Qt::LeftButton, Qt::NoModifier, board->cellRect(1, 1).center());
+    EXPECT_EQ(board->mark(1, 1), 'X');
+    // The AI answers in the same turn.
+    int marks = 0;
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col) {
+            marks += board->mark(row, col) != ' ' ? 1 : 0;
         }
-    };
-    checkForGridLayout(mainWindow);
-    EXPECT_TRUE(hasGridLayout) << "Should have a QGridLayout for the game board";
+    }
+    EXPECT_EQ(marks, 2);
+    mainWindow->hide();
 }
 
 // ============= USER-SPECIFIC TESTS =============
@@ -390,23 +395,6 @@ TEST_F(MainWindowTest, InitialGameStateIsCorrect) {
     EXPECT_TRUE(foundVsAIMode) << "Should show VS AI mode in test mode";
 }
 
-TEST_F(MainWindowTest, GameBoardCellsHaveConsistentStyling) {
-    createMainWindow(1);
-    auto gameCells = getGameBoardCells();
-    if (gameCells.size() >= 2) {
-        // Check that cells have similar styling patterns
-        QString firstCellStyle = gameCells[0]->styleSheet();
-        QString secondCellStyle = gameCells[1]->styleSheet();
-        // Both should have some styling (non-empty) or both should be empty
-        bool firstHasStyle = !firstCellStyle.isEmpty();
-        bool secondHasStyle = !secondCellStyle.isEmpty();
-        if (firstHasStyle || secondHasStyle) {
-            EXPECT_TRUE(firstHasStyle && secondHasStyle)
-                << "Game board cells should have consistent styling";
-        }
-    }
-}
-
 // ============= ERROR HANDLING TESTS =============
 TEST_F(MainWindowTest, HandlesNullDatabaseGracefully) {
     // This test checks if the constructor can handle edge cases
@@ -483,7 +471,7 @@ TEST_F(MainWindowTest, AllRequiredComponentsExistTogether) {
     bool hasVsAI = findButtonByText("VS AI") != nullptr;
     bool hasVsPlayer = findButtonByText("VS PLAYER") != nullptr;
     bool hasRestart = findButtonByText("RESTART") != nullptr;
-    bool hasGameBoard = getGameBoardCells().size() >= 9;
+    bool hasGameBoard = getGameBoard() != nullptr && getGameBoard()->boardSize() >= 3;
     
     EXPECT_TRUE(hasTitle) << "Should have title";
     EXPECT_TRUE(hasModeIndicator) << "Should have mode indicator";
@@ -530,3 +518,157 @@ TEST_F(MainWindowTest, ComponentsHaveReasonableObjectNames) {
         std::cout << "Note: Consider adding object names to UI components for better testability and accessibility\n";
     }
 }
+
+// ============= BOARD RENDERING TESTS =============
+TEST_F(MainWindowTest, BoardUpdateRepaintsOnlyChangedCells) {
+    BoardView view(3, true);
+    char board[3][3] = {{' ', ' ', ' '}, {' ', ' ', ' '}, {' ', ' ', ' '}};
+    EXPECT_EQ(view.setBoard(board), 0);
+    board[1][1] = 'X';
+    EXPECT_EQ(view.setBoard(board), 1);
+    EXPECT_EQ(view.mark(1, 1), 'X');
+    board[0][2] = 'O';
+    board[2][0] = 'X';
+    EXPECT_EQ(view.setBoard(board), 2);
+    EXPECT_EQ(view.setBoard(board), 0);
+}
+
+TEST_F(MainWindowTest, LargeBoardMapsClicksToCells) {
+    BoardView view(19, true);
+    view.resize(19 * 20, 19 * 20);
+    view.setCellsEnabled(true);
+    view.show();
+    QApplication::processEvents();
+    QSignalSpy clicks(&view, &BoardView::cellClicked);
+    QTest::mouseClick(&view, Qt::LeftButton, Qt::NoModifier, view.cellRect(5, 17).center());
+    ASSERT_EQ(clicks.size(), 1);
+    EXPECT_EQ(clicks.at(0).at(0).toInt(), 5);
+    EXPECT_EQ(clicks.at(0).at(1).toInt(), 17);
+
+    int row = -1;
+    int col = -1;
+    EXPECT_FALSE(view.cellAt(QPoint(-1, -1), &row, &col));
+    EXPECT_TRUE(view.cellAt(view.cellRect(18, 0).topLeft(), &row, &col));
+    EXPECT_EQ(row, 18);
+    EXPECT_EQ(col, 0);
+
+    // Disabled cells ignore clicks.
+    view.setCellsEnabled(false);
+    QTest::mouseClick(&view, Qt::LeftButton, Qt::NoModifier, view.cellRect(0, 0).center());
+    EXPECT_EQ(clicks.size(), 1);
+}
+
+TEST_F(MainWindowTest, BoardUpdateTimePerMove) {
+    // Replays the same 9-move games through the old per-move path (nine
+    // styled buttons, each given a fresh stylesheet) and through the painted
+    // board, and reports both. Timings are printed only; wall-clock
+    // comparisons are too noisy to assert on.
+    const int games = 50;
+    const int moves[9] = {4, 0, 8, 2, 6, 3, 5, 1, 7};
+    QWidget buttons;
+    QGridLayout *grid = new QGridLayout(&buttons);
+    QPushButton *cells[3][3];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            cells[i][j] = new QPushButton(&buttons);
+            grid->addWidget(cells[i][j], i, j);
+        }
+    }
+    BoardView view(3, true);
+    buttons.show();
+    view.show();
+    QApplication::processEvents();
+
+    QElapsedTimer clock;
+    clock.start();
+    for (int game = 0; game < games; ++game) {
+        char board[3][3] = {{' ', ' ', ' '}, {' ', ' ', ' '}, {' ', ' ', ' '}};
+        for (int move = 0; move < 9; ++move) {
+            board[moves[move] / 3][moves[move] % 3] = move % 2 ? 'O' : 'X';
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    cells[i][j]->setText(board[i][j] == ' ' ? QString() : QString(board[i][j]));
+                    cells[i][j]->setStyleSheet(QString("QPushButton { background-color: rgba(20, 20, 40, 0.7);"
+                                                       " border: 1px solid #bb00ff; font-size: 40px; color: %1;"
+                                                       " min-width: 100px; min-height: 100px; }")
+                                                   .arg(board[i][j] == 'X' ? "#00eaff"
+                                                        : board[i][j] == 'O' ? "#ff00cc" : "transparent"));
+                }
+            }
+            buttons.repaint();
+        }
+    }
+    const double fullRestyle = clock.nsecsElapsed() / 1000.0 / (games * 9);
+
+    clock.restart();
+    for (int game = 0; game < games; ++game) {
+        char board[3][3] = {{' ', ' ', ' '}, {' ', ' ', ' '}, {' ', ' ', ' '}};
+        view.setBoard(board);
+        for (int move = 0; move < 9; ++move) {
+            board[moves[move] / 3][moves[move] % 3] = move % 2 ? 'O' : 'X';
+            view.setBoard(board);
+            view.repaint(view.cellRect(moves[move] / 3, moves[move] % 3));
+        }
+    }
+    const double painted = clock.nsecsElapsed() / 1000.0 / (games * 9);
+    std::cout << "Board update per move: styled buttons " << fullRestyle << " us, painted board "
+              << painted << " us" << std::endl;
+
+    // After every move each cell holds its mark and shows its glyph colour,
+    // and only there.
+    auto showsColor = [](const QImage &image, const QRect &cell, const QColor &color) {
+        for (int y = cell.top(); y <= cell.bottom(); ++y) {
+            for (int x = cell.left(); x <= cell.right(); ++x) {
+                const QColor pixel = image.pixelColor(x, y);
+                if (qAbs(pixel.red() - color.red()) < 24 && qAbs(pixel.green() - color.green()) < 24
+                        && qAbs(pixel.blue() - color.blue()) < 24) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+    const QColor xColor(0x00, 0xea, 0xff);
+    const QColor oColor(0xff, 0x00, 0xcc);
+    char board[3][3] = {{' ', ' ', ' '}, {' ', ' ', ' '}, {' ', ' ', ' '}};
+    view.setBoard(board);
+    for (int move = 0; move < 9; ++move) {
+        board[moves[move] / 3][moves[move] % 3] = move % 2 ? 'O' : 'X';
+        view.setBoard(board);
+        const QImage image = view.grab().toImage().scaled(view.size());
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                const QRect cell = view.cellRect(i, j);
+                EXPECT_EQ(view.mark(i, j), board[i][j]) << "move " << move << " cell " << i << "," << j;
+                EXPECT_EQ(showsColor(image, cell, xColor), board[i][j] == 'X') << "move " << move << " cell " << i << "," << j;
+                EXPECT_EQ(showsColor(image, cell, oColor), board[i][j] == 'O') << "move " << move << " cell " << i << "," << j;
+            }
+        }
+    }
+}
+
+TEST_F(MainWindowTest, PerfHudIsIdleUntilActivated) {
+    createMainWindow(-1);
+    PerfHud* hud = mainWindow->findChild<PerfHud*>("perfHud");
+    ASSERT_NE(hud, nullptr);
+    EXPECT_FALSE(hud->isActive());
+    EXPECT_FALSE(hud->isVisibleTo(mainWindow));
+
+    // The AI search is timed whether or not the overlay is showing.
+    BoardView* board = getGameBoard();
+    emit board->cellClicked(1, 1);
+    EXPECT_GT(hud->lastAiSearchNanos(), 0);
+
+    mainWindow->show();
+    hud->setActive(true);
+    EXPECT_TRUE(hud->isVisible());
+    QTest::qWait(300);
+    board->update();
+    QTest::qWait(100);
+    EXPECT_GT(hud->lastFrameNanos(), 0);
+    EXPECT_GE(hud->longestStallMs(), hud->eventLoopLagMs());
+    EXPECT_TRUE(hud->text().contains("AI SEARCH"));
+
+    hud->setActive(false);
+    EXPECT_FALSE(hud->isVisible());
+}
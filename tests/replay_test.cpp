@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QSlider>
+#include <QPushButton>
+#include <QTest>
+#include <iostream>
+#include "ReplayTimeline.h"
+#include "ReplayWindow.h"
+
+TEST(ReplayTimelineTest, PrecomputesEveryPosition) {
+    ReplayTimeline timeline({4, 0, 8}, 3, 'O');
+    ASSERT_EQ(timeline.length(), 3);
+    EXPECT_EQ(timeline.positionAt(0), QVector<char>(9, ' '));
+    EXPECT_EQ(timeline.positionAt(1)[4], 'O');
+    EXPECT_EQ(timeline.positionAt(2)[0], 'X');
+    EXPECT_EQ(timeline.positionAt(3)[8], 'O');
+    EXPECT_EQ(timeline.positionAt(2)[8], ' ');
+    EXPECT_EQ(timeline.moveAt(0), -1);
+    EXPECT_EQ(timeline.moveAt(3), 8);
+    // Out-of-range steps are clamped.
+    EXPECT_EQ(timeline.positionAt(99), timeline.positionAt(3));
+}
+
+TEST(ReplayTimelineTest, StopsAtAnInvalidMove) {
+    ReplayTimeline timeline({4, 4, 0}, 3);
+    EXPECT_EQ(timeline.length(), 1);
+    EXPECT_EQ(ReplayTimeline({1, 9}, 3).length(), 1);
+}
+
+TEST(ReplayWindowTest, StepsSeeksAndPlays) {
+    GameRecord game;
+    game.moves = {4, 0, 8, 2, 6};
+    game.playerSymbol = 'X';
+    game.result = "X";
+    ReplayWindow window(game);
+    EXPECT_EQ(window.currentStep(), 0);
+
+    window.stepForward();
+    window.stepForward();
+    EXPECT_EQ(window.currentStep(), 2);
+    window.stepBack();
+    EXPECT_EQ(window.currentStep(), 1);
+    window.findChild<QSlider *>("replaySlider")->setValue(5);
+    EXPECT_EQ(window.currentStep(), 5);
+    window.stepForward();
+    EXPECT_EQ(window.currentStep(), 5);
+
+    window.setSpeed(1000.0);
+    EXPECT_DOUBLE_EQ(window.speed(), ReplayWindow::MaxSpeed);
+    window.setSpeed(0.0);
+    EXPECT_DOUBLE_EQ(window.speed(), ReplayWindow::MinSpeed);
+
+    // At 50x a move takes 20 ms; playing from the end starts over.
+    window.setSpeed(ReplayWindow::MaxSpeed);
+    window.play();
+    EXPECT_EQ(window.currentStep(), 0);
+    EXPECT_TRUE(window.isPlaying());
+    QElapsedTimer wait;
+    wait.start();
+    while (window.currentStep() < 5 && wait.elapsed() < 2000) {
+        QTest::qWait(10);
+    }
+    EXPECT_EQ(window.currentStep(), 5);
+    EXPECT_FALSE(window.isPlaying());
+}
+
+TEST(ReplayWindowTest, GameWithoutMovesShowsItsFinalBoard) {
+    GameRecord game;
+    game.board = "XXXOO    ";
+    game.result = "X";
+    ReplayWindow window(game);
+    EXPECT_EQ(window.replayTimeline().length(), 0);
+    BoardView *board = window.findChild<BoardView *>();
+    ASSERT_NE(board, nullptr);
+    EXPECT_EQ(board->mark(0, 0), 'X');
+    EXPECT_EQ(board->mark(1, 1), 'O');
+    EXPECT_EQ(board->mark(2, 2), ' ');
+    window.play();
+    EXPECT_FALSE(window.isPlaying());
+    EXPECT_FALSE(window.findChild<QPushButton *>("playButton")->isEnabled());
+}
+
+TEST(ReplayWindowTest, ScrubbingALargeBoardIsConstantTime) {
+    // Every cell of a 19x19 board, filled in order.
+    QVector<int> moves;
+    for (int cell = 0; cell < 19 * 19; ++cell) {
+        moves.append(cell);
+    }
+    ReplayWindow window(ReplayTimeline(moves, 19), "Tie");
+    ASSERT_EQ(window.replayTimeline().length(), 361);
+
+    QElapsedTimer clock;
+    clock.start();
+    for (int i = 0; i < 2000; ++i) {
+        window.seek(i % 2 ? 361 : (i * 37) % 361);
+    }
+    std::cout << "Seek on a 361-move replay: " << clock.nsecsElapsed() / 2000 / 1000.0 << " us" << std::endl;
+    EXPECT_EQ(window.currentStep(), 361);
+}
+
+int main(int argc, char **argv) {
+    QApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QPushButton>
+#include <QSignalSpy>
+#include <QTest>
+#include <iostream>
+#include "BoardView.h"
+#include "Database.h"
+#include "MainWindow.h"
+#include "UiDriver.h"
+
+namespace {
+
+// Latency budget for one move, AI reply and save included. Generous so a
+// busy CI machine passes, but far below what a blocking regression costs.
+constexpr qint64 BudgetNanos = 250 * 1000 * 1000;
+
+bool runToEnd(UiDriver &driver, int timeoutMs = 60000) {
+    QSignalSpy finished(&driver, &UiDriver::finished);
+    driver.start();
+    return finished.wait(timeoutMs);
+}
+
+}
+
+class UiDriverTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        db = std::make_unique<Database>(":memory:");
+        ASSERT_TRUE(db->registerUser("driver", "password"));
+        userId = db->authenticate("driver", "password");
+        window = new MainWindow(userId, db.get(), true);
+        window->resize(400, 500);
+        window->show();
+        ASSERT_TRUE(QTest::qWaitForWindowExposed(window));
+        board = window->findChild<BoardView *>();
+        ASSERT_NE(board, nullptr);
+    }
+
+    void TearDown() override {
+        if (window) {
+            window->close();
+        }
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    }
+
+    std::unique_ptr<Database> db;
+    int userId = -1;
+    MainWindow *window = nullptr;
+    BoardView *board = nullptr;
+};
+
+TEST_F(UiDriverTest, RandomMovesAgainstTheAIStayWithinBudget) {
+    UiDriver driver(board);
+    driver.setRandom(300);
+    ASSERT_TRUE(runToEnd(driver));
+
+    EXPECT_EQ(driver.movesPlayed() + driver.movesSkipped(), 300);
+    EXPECT_EQ(driver.movesSkipped(), 0);
+    EXPECT_GT(db->getUserStats(userId).aiGames, 0);
+    std::cout << "Click to repaint against the AI:\n" << driver.report().toStdString();
+    EXPECT_LT(driver.latency().percentile(99), BudgetNanos);
+}
+
+TEST_F(UiDriverTest, ScriptedMovesSkipCellsOffTheBoard) {
+    window->findChild<QPushButton *>("vsPlayerButton")->click();
+    UiDriver driver(board);
+    driver.setScript({4, 0, 99, 8});
+    ASSERT_TRUE(runToEnd(driver));
+
+    EXPECT_EQ(driver.movesPlayed(), 3);
+    EXPECT_EQ(driver.movesSkipped(), 1);
+    EXPECT_EQ(board->mark(1, 1), 'X');
+    EXPECT_EQ(board->mark(0, 0), 'O');
+    EXPECT_EQ(board->mark(2, 2), 'X');
+}
+
+TEST_F(UiDriverTest, FixedRatePacesMoves) {
+    window->findChild<QPushButton *>("vsPlayerButton")->click();
+    UiDriver driver(board);
+    driver.setRandom(8);
+    driver.setInterval(25);
+    QElapsedTimer elapsed;
+    elapsed.start();
+    ASSERT_TRUE(runToEnd(driver));
+
+    EXPECT_EQ(driver.movesPlayed(), 8);
+    EXPECT_GE(elapsed.elapsed(), 7 * 25);
+}
+
+TEST(UiDriverEnvironmentTest, ParsesSpecifications) {
+    BoardView board;
+    qputenv("TICTACTOE_UI_DRIVER", "random:50@10");
+    std::unique_ptr<UiDriver> random(UiDriver::fromEnvironment(&board));
+    EXPECT_NE(random, nullptr);
+    qputenv("TICTACTOE_UI_DRIVER", "script:4,0,8");
+    std::unique_ptr<UiDriver> script(UiDriver::fromEnvironment(&board));
+    EXPECT_NE(script, nullptr);
+    qputenv("TICTACTOE_UI_DRIVER", "script:4,x");
+    EXPECT_EQ(UiDriver::fromEnvironment(&board), nullptr);
+    qunsetenv("TICTACTOE_UI_DRIVER");
+    EXPECT_EQ(UiDriver::fromEnvironment(&board), nullptr);
+}
+
+int main(int argc, char **argv) {
+    QApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}